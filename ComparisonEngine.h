@@ -0,0 +1,452 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMap>
+#include <QRegularExpression>
+#include <type_traits>
+#include <vector>
+#include "DxDiagReport.h"
+#include "GameRequirements.h"
+#include "GpuAdapters.h"
+#include "HardwareModels.h"
+#include "HardwareDatabase.h"
+#include "HardwareMatcher.h"
+#include "ParallelFor.h"
+#include "Trace.h"
+
+
+inline int parseRam(const QString& ramStr) {
+    static const QRegularExpression re("(\\d+)(\\s*)(MB|GB|TB)", QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch match = re.match(ramStr);
+    if (match.hasMatch()) {
+        int value = match.captured(1).toInt();
+        QString unit = match.captured(3).toUpper();
+        if (unit == "GB") return value * 1024;
+        if (unit == "TB") return value * 1024 * 1024;
+        return value;
+    }
+    return 0;
+}
+
+inline int parseStorage(const QString& storageStr) {
+    static const QRegularExpression re("(\\d+)(\\s*)(MB|GB|TB)", QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch match = re.match(storageStr);
+    if (match.hasMatch()) {
+        int value = match.captured(1).toInt();
+        QString unit = match.captured(3).toUpper();
+        if (unit == "GB") return value * 1024;
+        if (unit == "TB") return value * 1024 * 1024;
+        return value;
+    }
+    return 0;
+}
+
+inline int cpuRank(QStringView cpuStr) {
+    return HardwareRankMatcher::instance().cpuRank(cpuStr);
+}
+
+inline int gpuRank(QStringView gpuStr) {
+    return HardwareRankMatcher::instance().gpuRank(gpuStr);
+}
+
+inline int parseVram(const QString& str) {
+    static const QRegularExpression re("(\\d+)(\\s*)(MB|GB)", QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch match = re.match(str);
+    if (match.hasMatch()) {
+        int value = match.captured(1).toInt();
+        QString unit = match.captured(3).toUpper();
+        if (unit == "GB") return value * 1024;
+        return value;
+    }
+    return 0;
+}
+
+
+enum class Verdict {
+    Unknown,
+    Meets,
+    MayNotMeet,
+    SystemInfoNotFound,
+    RequirementNotSpecified
+};
+
+inline QString verdictText(Verdict verdict, const QString& component) {
+    switch (verdict) {
+    case Verdict::Meets: return "Meets or Exceeds";
+    case Verdict::MayNotMeet: return "May Not Meet";
+    case Verdict::SystemInfoNotFound: return "System " + component + " Info Not Found";
+    case Verdict::RequirementNotSpecified: return "Requirement Not Specified";
+    case Verdict::Unknown: break;
+    }
+    return "Unknown";
+}
+
+struct ComparisonResult {
+    Verdict cpu = Verdict::Unknown;
+    Verdict gpu = Verdict::Unknown;
+    Verdict ram = Verdict::Unknown;
+    Verdict storage = Verdict::Unknown;
+
+    bool meetsAll() const {
+        return cpu == Verdict::Meets && gpu == Verdict::Meets && ram == Verdict::Meets && storage == Verdict::Meets;
+    }
+    bool anyFailing() const {
+        return cpu == Verdict::MayNotMeet || gpu == Verdict::MayNotMeet || ram == Verdict::MayNotMeet || storage == Verdict::MayNotMeet;
+    }
+    Verdict overall() const {
+        return meetsAll() ? Verdict::Meets : anyFailing() ? Verdict::MayNotMeet : Verdict::Unknown;
+    }
+};
+
+// Both sides of a comparison, normalized once when they are loaded: models
+// are interned, amounts are MB, and scores and tiers are looked up in
+// advance, so a comparison is a handful of integer compares. Both structs
+// are trivially copyable and fit in a cache line, so a catalog can be kept
+// as one contiguous array.
+struct SystemProfile {
+    ModelId cpuModel = 0;
+    ModelId gpuModel = 0;
+    quint32 cpuScore = 0;
+    quint32 gpuScore = 0;
+    qint32 cpuRank = 0;
+    qint32 gpuRank = 0;
+    qint32 vramMb = 0;
+    qint32 ramMb = 0;
+    qint32 storageMb = 0;
+    HardwareVendor cpuVendor = HardwareVendor::Unknown;
+    HardwareVendor gpuVendor = HardwareVendor::Unknown;
+    bool hasCpu = false;
+    bool hasGpu = false;
+    bool hasRam = false;
+    bool hasStorage = false;
+};
+
+// Requirement scores use the weakest model named ("i5-4460 or FX-6300"),
+// system scores the strongest.
+struct RequirementProfile {
+    ModelId cpuModel = 0;
+    ModelId gpuModel = 0;
+    quint32 cpuScore = 0;
+    quint32 gpuScore = 0;
+    qint32 cpuRank = 0;
+    qint32 gpuRank = 0;
+    qint32 vramMb = 0;
+    qint32 ramMb = 0;
+    qint32 storageMb = 0;
+    HardwareVendor cpuVendor = HardwareVendor::Unknown;
+    HardwareVendor gpuVendor = HardwareVendor::Unknown;
+    bool hasCpu = false;
+    bool hasGpu = false;
+    bool hasRam = false;
+    bool hasStorage = false;
+};
+
+static_assert(std::is_trivially_copyable_v<SystemProfile> && sizeof(SystemProfile) <= 64);
+static_assert(std::is_trivially_copyable_v<RequirementProfile> && sizeof(RequirementProfile) <= 64);
+
+inline SystemProfile buildSystemProfile(const QMap<QString, QString>& specs) {
+    SystemProfile profile;
+    profile.hasCpu = specs.contains("CPU");
+    profile.hasGpu = specs.contains("GPU");
+    profile.hasRam = specs.contains("RAM");
+    profile.hasStorage = specs.contains("Storage");
+    if (profile.hasCpu) {
+        const QString cpu = specs.value("CPU");
+        profile.cpuModel = ModelInterner::instance().intern(cpu);
+        profile.cpuVendor = hardwareVendor(cpu);
+        profile.cpuRank = cpuRank(cpu);
+        profile.cpuScore = HardwareDatabase::instance().score(HwdbKind::Cpu, cpu, HardwareDatabase::Policy::Best);
+    }
+    if (profile.hasGpu) {
+        const QString gpu = specs.value("GPU");
+        profile.gpuModel = ModelInterner::instance().intern(gpu);
+        profile.gpuVendor = hardwareVendor(gpu);
+        profile.gpuRank = gpuRank(gpu);
+        profile.gpuScore = HardwareDatabase::instance().score(HwdbKind::Gpu, gpu, HardwareDatabase::Policy::Best);
+        profile.vramMb = parseVram(specs.value("VRAM", gpu));
+    }
+    if (profile.hasRam) {
+        profile.ramMb = parseRam(specs.value("RAM"));
+    }
+    if (profile.hasStorage) {
+        profile.storageMb = parseStorage(specs.value("Storage"));
+    }
+    return profile;
+}
+
+// Normalizes the requirement fields that are set. The others keep what
+// `profile` already holds, which is how a tier inherits from the one below.
+inline void applyRequirementFields(RequirementProfile& profile, const QString& cpu, const QString& gpu, const QString& ram, const QString& storage) {
+    const HardwareDatabase& database = HardwareDatabase::instance();
+    if (!cpu.isEmpty()) {
+        profile.hasCpu = true;
+        profile.cpuModel = ModelInterner::instance().intern(cpu);
+        profile.cpuVendor = hardwareVendor(cpu);
+        profile.cpuRank = cpuRank(cpu);
+        profile.cpuScore = database.score(HwdbKind::Cpu, cpu, HardwareDatabase::Policy::Lowest);
+    }
+    if (!gpu.isEmpty()) {
+        profile.hasGpu = true;
+        profile.gpuModel = ModelInterner::instance().intern(gpu);
+        profile.gpuVendor = hardwareVendor(gpu);
+        profile.gpuRank = gpuRank(gpu);
+        profile.gpuScore = database.score(HwdbKind::Gpu, gpu, HardwareDatabase::Policy::Lowest);
+        profile.vramMb = parseVram(gpu);
+    }
+    if (!ram.isEmpty()) {
+        profile.hasRam = true;
+        profile.ramMb = parseRam(ram);
+    }
+    if (!storage.isEmpty()) {
+        profile.hasStorage = true;
+        profile.storageMb = parseStorage(storage);
+    }
+}
+
+inline RequirementProfile buildRequirementProfile(const GameRequirements& requirements) {
+    RequirementProfile profile;
+    applyRequirementFields(profile, requirements.cpu, requirements.gpu, requirements.ram, requirements.storage);
+    return profile;
+}
+
+// Minimum plus up to three higher tiers, normalized together. A tier field
+// that is empty or repeats the tier below is not normalized again, so a
+// "Recommended" block that only raises the GPU costs one GPU lookup.
+constexpr int kMaxRequirementTiers = 4;
+
+struct TieredRequirementProfile {
+    RequirementProfile tiers[kMaxRequirementTiers];
+    int count = 0;
+};
+
+inline TieredRequirementProfile buildTieredRequirementProfile(const GameRequirements& requirements) {
+    TieredRequirementProfile profile;
+    profile.tiers[0] = buildRequirementProfile(requirements);
+    profile.count = 1;
+    QString previous[] = {requirements.cpu, requirements.gpu, requirements.ram, requirements.storage};
+    for (const RequirementTier& tier : requirements.tiers) {
+        if (profile.count == kMaxRequirementTiers) break;
+        const QString fields[] = {tier.cpu, tier.gpu, tier.ram, tier.storage};
+        QString changed[4];
+        for (int i = 0; i < 4; ++i) {
+            if (fields[i].isEmpty() || fields[i] == previous[i]) continue;
+            changed[i] = fields[i];
+            previous[i] = fields[i];
+        }
+        RequirementProfile& next = profile.tiers[profile.count];
+        next = profile.tiers[profile.count - 1];
+        applyRequirementFields(next, changed[0], changed[1], changed[2], changed[3]);
+        ++profile.count;
+    }
+    return profile;
+}
+
+inline std::vector<RequirementProfile> buildRequirementProfiles(const QList<GameRequirements>& catalog, int threads = defaultWorkerCount()) {
+    std::vector<RequirementProfile> profiles(static_cast<std::size_t>(catalog.size()));
+    parallelFor(profiles.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            profiles[i] = buildRequirementProfile(catalog.at(static_cast<qsizetype>(i)));
+        }
+    });
+    return profiles;
+}
+
+inline std::vector<TieredRequirementProfile> buildTieredRequirementProfiles(const QList<GameRequirements>& catalog, int threads = defaultWorkerCount()) {
+    std::vector<TieredRequirementProfile> profiles(static_cast<std::size_t>(catalog.size()));
+    parallelFor(profiles.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            profiles[i] = buildTieredRequirementProfile(catalog.at(static_cast<qsizetype>(i)));
+        }
+    });
+    return profiles;
+}
+
+inline Verdict compareAmounts(int have, int need) {
+    if (have > 0 && need > 0) {
+        return have >= need ? Verdict::Meets : Verdict::MayNotMeet;
+    }
+    return Verdict::Unknown;
+}
+
+inline Verdict missingSideVerdict(bool hasSystem, bool hasRequirement) {
+    if (hasRequirement && !hasSystem) return Verdict::SystemInfoNotFound;
+    if (!hasRequirement && hasSystem) return Verdict::RequirementNotSpecified;
+    return Verdict::Unknown;
+}
+
+// Benchmark scores from the hardware database decide when both sides are
+// known SKUs; otherwise the tier heuristics from the rank matcher apply.
+inline ComparisonResult compareProfiles(const SystemProfile& system, const RequirementProfile& requirement) {
+    ComparisonResult result;
+
+    if (system.hasCpu && requirement.hasCpu) {
+        if (system.cpuScore > 0 && requirement.cpuScore > 0) {
+            result.cpu = system.cpuScore >= requirement.cpuScore ? Verdict::Meets : Verdict::MayNotMeet;
+        } else {
+            result.cpu = compareAmounts(system.cpuRank, requirement.cpuRank);
+        }
+    } else {
+        result.cpu = missingSideVerdict(system.hasCpu, requirement.hasCpu);
+    }
+
+    if (system.hasGpu && requirement.hasGpu) {
+        if (system.gpuScore > 0 && requirement.gpuScore > 0) {
+            result.gpu = system.gpuScore >= requirement.gpuScore ? Verdict::Meets : Verdict::MayNotMeet;
+        } else if (system.gpuRank > 0 && requirement.gpuRank > 0) {
+            if (system.gpuRank > requirement.gpuRank) {
+                result.gpu = Verdict::Meets;
+            } else if (system.gpuRank == requirement.gpuRank) {
+                Verdict byVram = compareAmounts(system.vramMb, requirement.vramMb);
+                result.gpu = byVram == Verdict::Unknown ? Verdict::Meets : byVram;
+            } else {
+                result.gpu = Verdict::MayNotMeet;
+            }
+        } else {
+            result.gpu = compareAmounts(system.vramMb, requirement.vramMb);
+        }
+    } else {
+        result.gpu = missingSideVerdict(system.hasGpu, requirement.hasGpu);
+    }
+
+    if (system.hasRam && requirement.hasRam) {
+        result.ram = compareAmounts(system.ramMb, requirement.ramMb);
+    } else {
+        result.ram = missingSideVerdict(system.hasRam, requirement.hasRam);
+    }
+
+    if (system.hasStorage && requirement.hasStorage) {
+        result.storage = compareAmounts(system.storageMb, requirement.storageMb);
+    } else {
+        result.storage = missingSideVerdict(system.hasStorage, requirement.hasStorage);
+    }
+
+    return result;
+}
+
+inline ComparisonResult compareRequirements(const SystemProfile& system, const GameRequirements& requirements) {
+    return compareProfiles(system, buildRequirementProfile(requirements));
+}
+
+inline std::vector<ComparisonResult> scoreBatch(const SystemProfile& system, const std::vector<RequirementProfile>& catalog, int threads = defaultWorkerCount()) {
+    std::vector<ComparisonResult> results(catalog.size());
+    parallelFor(results.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            results[i] = compareProfiles(system, catalog[i]);
+        }
+    });
+    return results;
+}
+
+struct TieredComparison {
+    ComparisonResult tiers[kMaxRequirementTiers];
+    int count = 0;
+    int highestMet = -1;  // index into the tiers, -1 when not even one is met
+};
+
+// Every tier in one pass over the normalized profiles.
+inline TieredComparison compareTiers(const SystemProfile& system, const TieredRequirementProfile& requirement) {
+    TieredComparison result;
+    result.count = requirement.count;
+    for (int i = 0; i < requirement.count; ++i) {
+        result.tiers[i] = compareProfiles(system, requirement.tiers[i]);
+        if (result.tiers[i].meetsAll()) result.highestMet = i;
+    }
+    return result;
+}
+
+inline std::vector<TieredComparison> scoreTiersBatch(const SystemProfile& system, const std::vector<TieredRequirementProfile>& catalog,
+                                                     int threads = defaultWorkerCount()) {
+    SYSREQ_TRACE_SCOPE("comparison");
+    std::vector<TieredComparison> results(catalog.size());
+    parallelFor(results.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            results[i] = compareTiers(system, catalog[i]);
+        }
+    });
+    return results;
+}
+
+
+// Disk sizes are raw byte counts in /x reports ("Free Space: 15777931264")
+// and rounded with a unit in /t reports ("Free Space: 11.8 GB").
+inline double diskSpaceBytes(const QString& labeledValue) {
+    static const QRegularExpression bytesRe("(\\d{10,})");
+    static const QRegularExpression unitRe("(\\d+(?:\\.\\d+)?)\\s*(MB|GB|TB)", QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch match = bytesRe.match(labeledValue);
+    if (match.hasMatch()) {
+        return match.captured(1).toDouble();
+    }
+    match = unitRe.match(labeledValue);
+    if (match.hasMatch()) {
+        double value = match.captured(1).toDouble();
+        QString unit = match.captured(2).toUpper();
+        if (unit == "TB") return value * 1099511627776.0;
+        if (unit == "GB") return value * 1073741824.0;
+        return value * 1048576.0;
+    }
+    return 0.0;
+}
+
+// Maps the parsed dxdiag sections onto the spec keys used by the comparison:
+// CPU, RAM, GPU and VRAM (of the strongest adapter), Storage (largest free
+// space) and StorageDisplay. Reads the report's arena in place; only the
+// values that end up in the specs are copied out.
+inline QMap<QString, QString> extractSystemSpecs(const DxDiagReport& report) {
+    SYSREQ_TRACE_SCOPE("spec extraction");
+    QMap<QString, QString> specs;
+
+    for (int s = 0; s < report.sectionCount(); ++s) {
+        const QStringView name = report.sectionName(s);
+        if (name == u"SystemInformation") {
+            for (int i = 0; i < report.itemCount(s); ++i) {
+                const int values = report.valueCount(s, i);
+                if (values > 0) {
+                    if (report.key(s, i) == u"Processor") {
+                        specs["CPU"] = report.value(s, i, values - 1).toString();
+                    } else if (report.key(s, i) == u"Memory") {
+                        specs["RAM"] = report.value(s, i, values - 1).toString();
+                    }
+                }
+            }
+        } else if (name == u"DisplayDevices") {
+            QList<GpuAdapter> adapters = parseGpuAdapters(report, s);
+            const int best = rankGpuAdapters(adapters);
+            if (best >= 0) {
+                specs["GPU"] = adapters.at(best).name;
+                if (adapters.at(best).dedicatedMb > 0) {
+                    specs["VRAM"] = QString::number(adapters.at(best).dedicatedMb) + " MB";
+                }
+            }
+        } else if (name == u"LogicalDisks") {
+            QStringList storageDetails;
+            double maxFreeGb = 0.0;
+            for (int i = 0; i < report.itemCount(s); ++i) {
+                if (report.valueCount(s, i) >= 3) {
+                    QString sizeStr = report.value(s, i, 2).toString();
+                    QString freeStr = report.value(s, i, 1).toString();
+                    QString sizeGb = sizeStr, freeGb = freeStr;
+                    double freeGbVal = 0.0;
+                    double sizeBytes = diskSpaceBytes(sizeStr);
+                    double freeBytes = diskSpaceBytes(freeStr);
+                    if (sizeBytes > 0) {
+                        sizeGb = QString::number(sizeBytes / 1073741824.0, 'f', 0) + " GB";
+                    }
+                    if (freeBytes > 0) {
+                        freeGbVal = freeBytes / 1073741824.0;
+                        freeGb = QString::number(freeGbVal, 'f', 0) + " GB";
+                    }
+                    if (freeGbVal > maxFreeGb) maxFreeGb = freeGbVal;
+                    storageDetails.append(report.value(s, i, 0).toString() + " (" + sizeGb + ") Free: " + freeGb);
+                }
+            }
+            if (!storageDetails.isEmpty()) {
+                specs["Storage"] = QString::number(maxFreeGb, 'f', 0) + " GB";
+                specs["StorageDisplay"] = storageDetails.join("; ");
+            }
+        }
+    }
+
+    return specs;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <vector>
+#include "DxDiagLazyReport.h"
+#include "ParallelFor.h"
+
+
+// Offline ingestion of pre-captured dxdiag reports: no dxdiag.exe launch,
+// so it runs anywhere Qt does.
+
+// Loads the schema sections of a capture. Only their byte ranges are
+// parsed; the rest of the report is skipped by DxDiagLazyReport's index.
+inline bool loadDxDiagCapture(const QString& path, DxDiagReport& report, QString& errorMessage) {
+    DxDiagLazyReport capture;
+    if (!capture.open(path, errorMessage)) {
+        return false;
+    }
+    report = capture.toReport();
+    return true;
+}
+
+// Expands files and directories (recursively) into the list of capture
+// files to ingest: *.xml and *.txt.
+inline QStringList findDxDiagCaptures(const QStringList& inputs) {
+    QStringList captures;
+    for (const QString& input : inputs) {
+        QFileInfo info(input);
+        if (info.isDir()) {
+            QDirIterator it(input, {"*.xml", "*.txt"}, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                captures.append(it.next());
+            }
+        } else {
+            captures.append(input);
+        }
+    }
+    return captures;
+}
+
+struct IngestedReport {
+    QString path;
+    DxDiagReport parsed;
+    QString error;
+
+    bool ok() const { return error.isEmpty(); }
+};
+
+inline std::vector<IngestedReport> ingestDxDiagCaptures(const QStringList& paths, int threads = defaultWorkerCount()) {
+    std::vector<IngestedReport> reports(static_cast<std::size_t>(paths.size()));
+    parallelFor(reports.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            IngestedReport& report = reports[i];
+            report.path = paths.at(qsizetype(i));
+            QString errorMessage;
+            if (!loadDxDiagCapture(report.path, report.parsed, errorMessage)) {
+                report.error = errorMessage.isEmpty() ? QStringLiteral("Unknown error") : errorMessage;
+            }
+        }
+    });
+    return reports;
+}
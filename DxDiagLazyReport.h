@@ -0,0 +1,318 @@
+#pragma once
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include "DxDiagParser.h"
+#include "DxDiagTextParser.h"
+#include "DxDiagTextScanner.h"
+
+
+// Both /x (XML) and /t (text) captures are accepted; the format is sniffed
+// from the first bytes, not the extension.
+enum class DxDiagCaptureFormat {
+    Unknown,
+    Xml,
+    Text
+};
+
+inline DxDiagCaptureFormat detectDxDiagFormat(const QByteArray& head) {
+    QByteArray probe = head;
+    if (probe.startsWith("\xEF\xBB\xBF")) probe.remove(0, 3);
+    if (probe.startsWith("\xFF\xFE") || probe.startsWith("\xFE\xFF")) {
+        // UTF-16: look at the first character after the BOM.
+        char first = probe.size() > 3 ? (probe.at(2) != 0 ? probe.at(2) : probe.at(3)) : 0;
+        return first == '<' ? DxDiagCaptureFormat::Xml : DxDiagCaptureFormat::Text;
+    }
+    probe = probe.trimmed();
+    if (probe.startsWith('<')) return DxDiagCaptureFormat::Xml;
+    if (probe.startsWith('-')) return DxDiagCaptureFormat::Text;
+    return DxDiagCaptureFormat::Unknown;
+}
+
+// Calls onSection(name, begin, end) for each child element of the XML
+// document element, with [begin, end) spanning its start tag through its
+// end tag. Only markup is examined: '<' is found with memchr and text runs
+// are skipped whole. Comments, CDATA, processing instructions and quoted
+// attribute values are stepped over. Returns the byte offset just past the
+// root start tag, or 0 if there is none.
+template <typename OnSection>
+std::size_t dxdiagScanXmlSections(const char* data, std::size_t size, OnSection&& onSection) {
+    auto find = [&](std::size_t from, std::string_view needle) {
+        for (std::size_t pos = from; pos + needle.size() <= size;) {
+            const char* hit = static_cast<const char*>(std::memchr(data + pos, needle[0], size - pos));
+            if (!hit) break;
+            pos = std::size_t(hit - data);
+            if (pos + needle.size() <= size && std::memcmp(hit, needle.data(), needle.size()) == 0) return pos;
+            ++pos;
+        }
+        return size;
+    };
+    auto isNameEnd = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '/' || c == '>'; };
+
+    std::size_t rootEnd = 0;
+    int depth = 0;
+    std::string_view sectionName;
+    std::size_t sectionBegin = 0;
+    std::size_t pos = 0;
+    while (pos < size) {
+        const char* open = static_cast<const char*>(std::memchr(data + pos, '<', size - pos));
+        if (!open) break;
+        const std::size_t tag = std::size_t(open - data);
+        const std::string_view rest(open, size - tag);
+        if (rest.substr(0, 4) == "<!--") {
+            pos = find(tag + 4, "-->") + 3;
+        } else if (rest.substr(0, 9) == "<![CDATA[") {
+            pos = find(tag + 9, "]]>") + 3;
+        } else if (rest.substr(0, 2) == "<?") {
+            pos = find(tag + 2, "?>") + 2;
+        } else if (rest.substr(0, 2) == "<!") {
+            pos = find(tag + 2, ">") + 1;  // DOCTYPE without an internal subset
+        } else if (rest.substr(0, 2) == "</") {
+            pos = find(tag + 2, ">") + 1;
+            if (--depth == 1) onSection(sectionName, sectionBegin, std::min(pos, size));
+            if (depth <= 0) break;  // </DxDiag>
+        } else {
+            std::size_t nameEnd = tag + 1;
+            while (nameEnd < size && !isNameEnd(data[nameEnd])) ++nameEnd;
+            std::size_t end = nameEnd;
+            char quote = 0;
+            for (; end < size; ++end) {
+                const char c = data[end];
+                if (quote) {
+                    if (c == quote) quote = 0;
+                } else if (c == '"' || c == '\'') {
+                    quote = c;
+                } else if (c == '>') {
+                    break;
+                }
+            }
+            pos = end + 1;
+            const bool empty = end < size && data[end - 1] == '/';
+            if (depth == 0) {
+                rootEnd = std::min(pos, size);
+            } else if (depth == 1) {
+                sectionName = std::string_view(data + tag + 1, nameEnd - tag - 1);
+                sectionBegin = tag;
+                if (empty) onSection(sectionName, sectionBegin, std::min(pos, size));
+            }
+            if (!empty) ++depth;
+            if (depth == 0) break;  // <DxDiag/>
+        }
+    }
+    return rootEnd;
+}
+
+// A dxdiag capture opened for on-demand parsing. open() maps the file and
+// records where each top-level section starts and ends (a byte scan, no
+// tokenizing); section() parses just that byte range the first time it is
+// asked for. Getting the CPU and GPU out of a multi-megabyte report then
+// costs the size of SystemInformation and DisplayDevices, not the size of
+// the whole file.
+class DxDiagLazyReport {
+public:
+    struct SectionSpan {
+        QString name;  // XML element or text banner title
+        qint64 begin;
+        qint64 end;
+    };
+
+    DxDiagLazyReport() = default;
+    DxDiagLazyReport(const DxDiagLazyReport&) = delete;
+    DxDiagLazyReport& operator=(const DxDiagLazyReport&) = delete;
+    ~DxDiagLazyReport() { close(); }
+
+    bool open(const QString& path, QString& errorMessage) {
+        close();
+        m_file.setFileName(path);
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            errorMessage = "Could not open " + path;
+            return false;
+        }
+        if (m_file.size() > 0) {
+            m_mapped = m_file.map(0, m_file.size());
+        }
+        if (m_mapped) {
+            m_data = reinterpret_cast<const char*>(m_mapped);
+            m_size = m_file.size();
+        } else {
+            m_buffer = m_file.readAll();
+            m_data = m_buffer.constData();
+            m_size = m_buffer.size();
+        }
+        return index(path, errorMessage);
+    }
+
+    // For captures already in memory; `data` is kept (implicitly shared).
+    bool openData(const QByteArray& data, QString& errorMessage) {
+        close();
+        m_buffer = data;
+        m_data = m_buffer.constData();
+        m_size = m_buffer.size();
+        return index(QStringLiteral("Input"), errorMessage);
+    }
+
+    void close() {
+        if (m_mapped) {
+            m_file.unmap(m_mapped);
+            m_mapped = nullptr;
+        }
+        m_file.close();
+        m_buffer.clear();
+        m_prolog.clear();
+        m_data = nullptr;
+        m_size = 0;
+        m_format = DxDiagCaptureFormat::Unknown;
+        m_spans.clear();
+        m_parsed.clear();
+    }
+
+    DxDiagCaptureFormat format() const { return m_format; }
+    const QList<SectionSpan>& spans() const { return m_spans; }
+
+    // The section described by `schema`, parsed on first use, as a report
+    // of that one section; nullptr if the report does not contain it or it
+    // does not parse.
+    const DxDiagReport* section(const DxDiagSectionSchema& schema) {
+        const QString key = schema.element.toString();
+        auto it = m_parsed.constFind(key);
+        if (it == m_parsed.constEnd()) {
+            it = m_parsed.insert(key, parse(schema));
+        }
+        return it->has_value() ? &**it : nullptr;
+    }
+
+    const DxDiagReport* section(QStringView element) {
+        const DxDiagSectionSchema* schema = findDxDiagSection(element);
+        return schema ? section(*schema) : nullptr;
+    }
+
+    // Raw bytes of the section described by `schema`, empty if absent.
+    QByteArrayView bytes(const DxDiagSectionSchema& schema) const {
+        const QList<DxDiagSectionSchema> only = {schema};
+        for (const SectionSpan& span : m_spans) {
+            if (schemaFor(span, only)) return QByteArrayView(m_data + span.begin, span.end - span.begin);
+        }
+        return {};
+    }
+
+    // The schema sections present in the report, in report order, as one
+    // report. `step` is told how many spans are done; returning false stops
+    // early.
+    DxDiagReport toReport(const QList<DxDiagSectionSchema>& schema = dxDiagSchema(),
+                          const std::function<bool(int done, int total)>& step = {}) {
+        DxDiagReport::Builder result;
+        int done = 0;
+        for (const SectionSpan& span : m_spans) {
+            if (step && !step(done++, int(m_spans.size()))) break;
+            if (const DxDiagSectionSchema* match = schemaFor(span, schema)) {
+                if (const DxDiagReport* data = section(*match)) result.appendSection(*data, 0);
+            }
+        }
+        return result.build();
+    }
+
+private:
+    const DxDiagSectionSchema* schemaFor(const SectionSpan& span, const QList<DxDiagSectionSchema>& schema) const {
+        for (const DxDiagSectionSchema& section : schema) {
+            if ((m_format == DxDiagCaptureFormat::Xml ? section.element : section.textSection) == span.name) return &section;
+        }
+        return nullptr;
+    }
+
+    bool index(const QString& name, QString& errorMessage) {
+        m_format = detectDxDiagFormat(QByteArray::fromRawData(m_data, qsizetype(std::min<qint64>(m_size, 64))));
+        const bool utf16 = isDxDiagUtf16(m_data, m_size);
+        if (utf16) {
+            m_buffer = dxdiagUtf16ToUtf8(QByteArrayView(m_data, m_size));
+            if (m_mapped) {
+                m_file.unmap(m_mapped);
+                m_mapped = nullptr;
+            }
+            m_data = m_buffer.constData();
+            m_size = m_buffer.size();
+        } else if (m_size >= 3 && std::string_view(m_data, 3) == "\xEF\xBB\xBF") {
+            m_data += 3;
+            m_size -= 3;
+        }
+
+        const std::size_t size = std::size_t(m_size);
+        switch (m_format) {
+        case DxDiagCaptureFormat::Xml: {
+            const std::size_t rootEnd = dxdiagScanXmlSections(m_data, size, [&](std::string_view name, std::size_t begin, std::size_t end) {
+                m_spans.append({QString::fromLatin1(name.data(), qsizetype(name.size())), qint64(begin), qint64(end)});
+            });
+            const std::size_t root = rootEnd > 0 ? std::string_view(m_data, rootEnd).rfind('<') : std::string_view::npos;
+            const std::string_view rootTag = root == std::string_view::npos ? std::string_view() : std::string_view(m_data + root, rootEnd - root);
+            if (rootTag.substr(0, 7) != "<DxDiag" || (rootTag.size() > 7 && std::strchr(" \t\r\n/>", rootTag[7]) == nullptr)) {
+                errorMessage = "Could not find DxDiag root element in XML.";
+                return false;
+            }
+            // Each slice is parsed behind the file's own XML declaration, so
+            // it is decoded the same way. Converted UTF-16 is UTF-8 by now.
+            if (!utf16) m_prolog = QByteArray(m_data, qsizetype(root));
+            return true;
+        }
+        case DxDiagCaptureFormat::Text:
+            dxdiagScanBanners(m_data, size, [&](std::string_view title, std::size_t offset) {
+                if (!m_spans.isEmpty()) m_spans.last().end = qint64(offset);
+                m_spans.append({QString::fromLatin1(title.data(), qsizetype(title.size())), qint64(offset), m_size});
+            });
+            if (m_spans.isEmpty()) {
+                errorMessage = "No dxdiag section banners found in text report.";
+                return false;
+            }
+            return true;
+        case DxDiagCaptureFormat::Unknown:
+            break;
+        }
+        errorMessage = name + " is not a dxdiag /x or /t report";
+        return false;
+    }
+
+    std::optional<DxDiagReport> parse(const DxDiagSectionSchema& schema) const {
+        const QList<DxDiagSectionSchema> only = {schema};
+        for (const SectionSpan& span : m_spans) {
+            if (!schemaFor(span, only)) continue;
+            const char* begin = m_data + span.begin;
+            const qsizetype length = qsizetype(span.end - span.begin);
+            DxDiagReport::Builder builder;
+            QString errorMessage;
+            bool ok = false;
+            if (m_format == DxDiagCaptureFormat::Xml) {
+                QBuffer buffer;
+                buffer.setData(m_prolog + "<DxDiag>" + QByteArray::fromRawData(begin, length) + "</DxDiag>");
+                buffer.open(QIODevice::ReadOnly);
+                ok = parseDxDiagXml(&buffer, builder, errorMessage, only);
+            } else {
+                ok = parseDxDiagText(begin, std::size_t(length), builder, errorMessage, only);
+            }
+            DxDiagReport parsed = builder.build();
+            if (!ok || parsed.isEmpty()) {
+                qDebug() << "Could not parse section" << span.name << ":" << errorMessage;
+                return std::nullopt;
+            }
+            return parsed;
+        }
+        return std::nullopt;
+    }
+
+    QFile m_file;
+    uchar* m_mapped = nullptr;
+    QByteArray m_buffer;
+    QByteArray m_prolog;
+    const char* m_data = nullptr;
+    qint64 m_size = 0;
+    DxDiagCaptureFormat m_format = DxDiagCaptureFormat::Unknown;
+    QList<SectionSpan> m_spans;
+    QHash<QString, std::optional<DxDiagReport>> m_parsed;
+};
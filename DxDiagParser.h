@@ -0,0 +1,252 @@
+#pragma once
+
+#include <QIODevice>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QXmlStreamReader>
+#include <QDebug>
+#include <array>
+#include <optional>
+#include "DxDiagReport.h"
+
+
+// Declarative description of what to keep from a dxdiag report. Each
+// section names its XML element (/x) and banner title (/t), the element of
+// one record inside it (none for flat sections such as SystemInformation)
+// and the fields to extract, by XML element and by text key. Records are
+// emitted with their fields in schema order and keyed by XML element name,
+// so both formats produce the same section model.
+struct DxDiagFieldSchema {
+    QStringView element;
+    QStringView textKey;
+    QStringView label;  // Composite sections only: "Label: value"
+};
+
+struct DxDiagSectionSchema {
+    enum class Style {
+        Pairs,     // one {element, value} item per field present
+        Composite  // one item per record: {"Label: value", ...}, "N/A" if missing
+    };
+
+    QStringView element;
+    QStringView textSection;
+    QStringView recordElement;
+    Style style;
+    QList<DxDiagFieldSchema> fields;
+};
+
+inline const QList<DxDiagSectionSchema>& dxDiagSchema() {
+    static const QList<DxDiagSectionSchema> schema = {
+        {u"SystemInformation", u"System Information", {}, DxDiagSectionSchema::Style::Pairs, {
+            {u"MachineName", u"Machine name", {}}, {u"OperatingSystem", u"Operating System", {}},
+            {u"SystemManufacturer", u"System Manufacturer", {}}, {u"SystemModel", u"System Model", {}},
+            {u"Processor", u"Processor", {}}, {u"Memory", u"Memory", {}},
+            {u"DirectXVersion", u"DirectX Version", {}}
+        }},
+        {u"DisplayDevices", u"Display Devices", u"DisplayDevice", DxDiagSectionSchema::Style::Pairs, {
+            {u"CardName", u"Card name", {}}, {u"Manufacturer", u"Manufacturer", {}},
+            {u"ChipType", u"Chip type", {}}, {u"VendorID", u"Vendor ID", {}},
+            {u"DeviceID", u"Device ID", {}}, {u"DeviceKey", u"Device Key", {}},
+            {u"DedicatedMemory", u"Dedicated Memory", {}}, {u"SharedMemory", u"Shared Memory", {}},
+            {u"CurrentMode", u"Current Mode", {}}, {u"DriverVersion", u"Driver Version", {}},
+            {u"DriverModel", u"Driver Model", {}}, {u"FeatureLevels", u"Feature Levels", {}},
+            {u"HybridGraphicsGPUType", u"Hybrid Graphics GPU", {}}
+        }},
+        {u"LogicalDisks", u"Disk & DVD/CD-ROM Drives", u"LogicalDisk", DxDiagSectionSchema::Style::Composite, {
+            {u"DriveLetter", u"Drive", u"Drive"}, {u"FreeSpace", u"Free Space", u"Free Space"},
+            {u"MaxSpace", u"Total Space", u"Size"}, {u"FileSystem", u"File System", u"File System"},
+            {u"Model", u"Model", u"Model"}
+        }}
+    };
+    return schema;
+}
+
+inline const DxDiagSectionSchema* findDxDiagSection(QStringView element, const QList<DxDiagSectionSchema>& schema = dxDiagSchema()) {
+    for (const DxDiagSectionSchema& section : schema) {
+        if (section.element == element) return &section;
+    }
+    return nullptr;
+}
+
+constexpr int DxDiagMaxSchemaFields = 16;
+
+// Collects the fields of one record and appends it to the report in the
+// shape its schema asks for. Values go into the report's arena as they
+// arrive; flushRecord() then attaches them to items in schema order. The
+// first value seen for a field wins, which keeps nested text blocks (e.g.
+// extension drivers) from overwriting the device's own fields.
+class DxDiagRecordBuilder {
+public:
+    DxDiagRecordBuilder(DxDiagReport::Builder& report, const DxDiagSectionSchema& schema) : m_report(report), m_schema(schema) {
+        Q_ASSERT(schema.fields.size() <= DxDiagMaxSchemaFields);
+        m_report.beginSection(schema.element);
+    }
+
+    int fieldIndex(QStringView element) const {
+        for (int i = 0; i < m_schema.fields.size(); ++i) {
+            if (m_schema.fields.at(i).element == element) return i;
+        }
+        return -1;
+    }
+
+    int textFieldIndex(QLatin1StringView key) const {
+        for (int i = 0; i < m_schema.fields.size(); ++i) {
+            if (m_schema.fields.at(i).textKey == key) return i;
+        }
+        return -1;
+    }
+
+    bool hasPendingRecord() const { return m_dirty; }
+
+    // A value may arrive in pieces: beginValue(), appendValue()..., then
+    // endValue(). beginValue() is false if the field is unknown (-1) or
+    // already has a value.
+    bool beginValue(int field) {
+        if (field < 0 || m_present[size_t(field)]) return false;
+        m_field = field;
+        m_record[size_t(field)].offset = m_report.textSize();
+        if (composite()) m_report.appendText(m_schema.fields.at(field).label, QStringView(u": "));
+        m_valueStart = m_report.textSize();
+        return true;
+    }
+
+    template <typename Text>
+    void appendValue(const Text& text) { m_report.appendText(text); }
+
+    void endValue() {
+        if (composite() && m_report.textSize() == m_valueStart) m_report.appendText(QStringView(u"N/A"));
+        Value& value = m_record[size_t(m_field)];
+        value.length = m_report.textSize() - value.offset;
+        value.empty = m_report.textSize() == m_valueStart;
+        m_present[size_t(m_field)] = true;
+        m_dirty = true;
+    }
+
+    void setValue(int field, QStringView value) {
+        if (!beginValue(field)) return;
+        appendValue(value);
+        endValue();
+    }
+
+    void flushRecord() {
+        if (composite()) {
+            m_report.beginItem();
+            for (int i = 0; i < m_schema.fields.size(); ++i) {
+                if (!m_present[size_t(i)]) {
+                    beginValue(i);
+                    endValue();
+                }
+                m_report.addValue(m_record[size_t(i)].offset, m_record[size_t(i)].length);
+            }
+        } else {
+            for (int i = 0; i < m_schema.fields.size(); ++i) {
+                if (m_present[size_t(i)] && !m_record[size_t(i)].empty) {
+                    m_report.beginItem(m_schema.fields.at(i).element);
+                    m_report.addValue(m_record[size_t(i)].offset, m_record[size_t(i)].length);
+                }
+            }
+        }
+        m_present.fill(false);
+        m_dirty = false;
+    }
+
+    const DxDiagSectionSchema& schema() const { return m_schema; }
+
+private:
+    struct Value {
+        qsizetype offset = 0;
+        qsizetype length = 0;
+        bool empty = true;
+    };
+
+    bool composite() const { return m_schema.style == DxDiagSectionSchema::Style::Composite; }
+
+    DxDiagReport::Builder& m_report;
+    const DxDiagSectionSchema& m_schema;
+    std::array<Value, DxDiagMaxSchemaFields> m_record;
+    std::array<bool, DxDiagMaxSchemaFields> m_present{};
+    int m_field = 0;
+    qsizetype m_valueStart = 0;
+    bool m_dirty = false;
+};
+
+// Single pass over a dxdiag XML report into `report`. Element names are
+// compared as QStringView against the schema and kept values are appended
+// from the reader's buffer to the report's arena, so nothing is allocated
+// per field. Unknown sections and fields are skipped without being
+// materialized.
+inline bool parseDxDiagXml(QIODevice* device, DxDiagReport::Builder& report, QString& errorMessage,
+                           const QList<DxDiagSectionSchema>& schema = dxDiagSchema()) {
+    QXmlStreamReader xml(device);
+    if (!xml.readNextStartElement() || xml.name() != u"DxDiag") {
+        errorMessage = "Could not find DxDiag root element in XML.";
+        return false;
+    }
+
+    std::optional<DxDiagRecordBuilder> builder;
+    bool inRecord = false;
+
+    while (!xml.atEnd()) {
+        QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::StartElement) {
+            if (!builder) {
+                const DxDiagSectionSchema* section = findDxDiagSection(xml.name(), schema);
+                if (!section) {
+                    xml.skipCurrentElement();
+                    continue;
+                }
+                builder.emplace(report, *section);
+                inRecord = section->recordElement.isEmpty();
+                continue;
+            }
+            if (!inRecord) {
+                if (xml.name() == builder->schema().recordElement) {
+                    inRecord = true;
+                } else {
+                    xml.skipCurrentElement();
+                }
+                continue;
+            }
+            int field = builder->fieldIndex(xml.name());
+            if (field >= 0 && builder->beginValue(field)) {
+                // readElementText(SkipChildElements), without the QString.
+                while (!xml.atEnd()) {
+                    token = xml.readNext();
+                    if (token == QXmlStreamReader::Characters || token == QXmlStreamReader::EntityReference) {
+                        builder->appendValue(xml.text());
+                    } else if (token == QXmlStreamReader::StartElement) {
+                        xml.skipCurrentElement();
+                    } else if (token == QXmlStreamReader::EndElement) {
+                        break;
+                    }
+                }
+                builder->endValue();
+            } else {
+                xml.skipCurrentElement();
+            }
+        } else if (token == QXmlStreamReader::EndElement) {
+            if (!builder) {
+                break;  // </DxDiag>
+            }
+            const DxDiagSectionSchema& section = builder->schema();
+            if (!section.recordElement.isEmpty() && inRecord && xml.name() == section.recordElement) {
+                builder->flushRecord();
+                inRecord = false;
+            } else if (xml.name() == section.element) {
+                if (section.recordElement.isEmpty()) {
+                    builder->flushRecord();
+                }
+                builder.reset();
+                inRecord = false;
+            }
+        }
+    }
+
+    if (xml.hasError()) {
+        errorMessage = "XML parsing error: " + xml.errorString();
+        return false;
+    }
+    return true;
+}
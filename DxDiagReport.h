@@ -0,0 +1,160 @@
+#pragma once
+
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <memory>
+#include <vector>
+
+
+// A parsed report, frozen. Every value lives in one UTF-16 arena and is
+// addressed by offset and length; item keys ("Processor", "CardName") and
+// section names are interned once in a key table. Copies share the same
+// immutable data through one reference count, so handing a report to the
+// GUI thread or keeping hundreds of them costs a pointer each.
+//
+// Items of a pairs section are {key, value}; composite records (a
+// LogicalDisk) have no key and keep all their values. The parsers write
+// straight into a Builder, so a value is copied once, into the arena.
+class DxDiagReport {
+    struct Data;
+
+public:
+    class Builder {
+    public:
+        Builder() : m_data(std::make_shared<Data>()) {}
+
+        void beginSection(QStringView name) {
+            m_data->sections.push_back({intern(name), quint32(m_data->items.size()), 0});
+        }
+
+        // An empty key starts a record without one.
+        void beginItem(QStringView key = {}) {
+            m_data->items.push_back({key.isEmpty() ? -1 : intern(key), quint32(m_data->fields.size()), 0});
+            ++m_data->sections.back().itemCount;
+        }
+
+        // Values are written to the arena first and attached to the current
+        // item afterwards, so a record can collect its fields in any order.
+        qsizetype textSize() const { return m_data->text.size(); }
+
+        template <typename... Parts>
+        void appendText(const Parts&... parts) {
+            (m_data->text.append(parts), ...);
+        }
+
+        void addValue(qsizetype offset, qsizetype length) {
+            m_data->fields.push_back({quint32(offset), quint32(length)});
+            ++m_data->items.back().fieldCount;
+        }
+
+        void addValue(QStringView value) {
+            const qsizetype offset = textSize();
+            appendText(value);
+            addValue(offset, value.size());
+        }
+
+        void appendSection(const DxDiagReport& report, int section) {
+            beginSection(report.sectionName(section));
+            for (int i = 0; i < report.itemCount(section); ++i) {
+                beginItem(report.key(section, i));
+                for (int v = 0; v < report.valueCount(section, i); ++v) addValue(report.value(section, i, v));
+            }
+        }
+
+        DxDiagReport build() {
+            m_data->text.squeeze();
+            DxDiagReport report;
+            report.m_data = std::move(m_data);
+            m_data = std::make_shared<Data>();
+            return report;
+        }
+
+    private:
+        // A report has a few dozen distinct keys; a scan beats hashing them.
+        int intern(QStringView key) {
+            for (qsizetype i = 0; i < m_data->keys.size(); ++i) {
+                if (m_data->keys.at(i) == key) return int(i);
+            }
+            m_data->keys.append(key.toString());
+            return int(m_data->keys.size() - 1);
+        }
+
+        std::shared_ptr<Data> m_data;
+    };
+
+    DxDiagReport() = default;
+
+    bool isEmpty() const { return !m_data || m_data->sections.empty(); }
+    int sectionCount() const { return m_data ? int(m_data->sections.size()) : 0; }
+
+    QStringView sectionName(int section) const { return m_data->keys.at(m_data->sections[std::size_t(section)].name); }
+
+    int findSection(QStringView name) const {
+        for (int i = 0; i < sectionCount(); ++i) {
+            if (sectionName(i) == name) return i;
+        }
+        return -1;
+    }
+
+    int itemCount(int section) const { return int(m_data->sections[std::size_t(section)].itemCount); }
+
+    bool hasKey(int section, int item) const { return this->item(section, item).key >= 0; }
+
+    // Empty for items without a key.
+    QStringView key(int section, int item) const {
+        const Item& entry = this->item(section, item);
+        return entry.key >= 0 ? QStringView(m_data->keys.at(entry.key)) : QStringView();
+    }
+
+    int valueCount(int section, int item) const { return int(this->item(section, item).fieldCount); }
+
+    QStringView value(int section, int item, int index) const {
+        const Field& field = m_data->fields[this->item(section, item).firstField + std::size_t(index)];
+        return QStringView(m_data->text).mid(field.offset, field.length);
+    }
+
+    // Heap bytes held by the report, shared by all its copies.
+    qsizetype memoryUsage() const {
+        if (!m_data) return 0;
+        qsizetype bytes = m_data->text.capacity() * qsizetype(sizeof(QChar));
+        for (const QString& key : m_data->keys) bytes += key.capacity() * qsizetype(sizeof(QChar));
+        bytes += qsizetype(m_data->sections.capacity() * sizeof(Section) + m_data->items.capacity() * sizeof(Item) + m_data->fields.capacity() * sizeof(Field));
+        return bytes;
+    }
+
+private:
+    struct Section {
+        int name;
+        quint32 firstItem;
+        quint32 itemCount;
+    };
+
+    struct Item {
+        int key;  // -1: none
+        quint32 firstField;
+        quint32 fieldCount;
+    };
+
+    struct Field {
+        quint32 offset;
+        quint32 length;
+    };
+
+    struct Data {
+        QString text;
+        QStringList keys;
+        std::vector<Section> sections;
+        std::vector<Item> items;
+        std::vector<Field> fields;
+    };
+
+    const Item& item(int section, int item) const {
+        return m_data->items[m_data->sections[std::size_t(section)].firstItem + std::size_t(item)];
+    }
+
+    std::shared_ptr<const Data> m_data;
+};
+
+Q_DECLARE_METATYPE(DxDiagReport)
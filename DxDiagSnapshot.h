@@ -0,0 +1,226 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include "DxDiagLazyReport.h"
+#include "DxDiagReport.h"
+
+
+// The last dxdiag run, kept on disk so a refresh can tell which sections
+// changed. Each section carries two hashes: one of its raw bytes, which
+// lets an identical section skip parsing, and a fingerprint of the schema
+// fields (Device Key, Driver Version, Memory, ...), which decides whether
+// it changed. Fields the schema drops, such as the report time, therefore
+// never count as a change.
+struct DxDiagSectionSnapshot {
+    DxDiagReport data;  // this section only
+    QByteArray rawHash;
+    QByteArray fingerprint;
+
+    QStringView name() const { return data.sectionName(0); }
+};
+
+class DxDiagSnapshot {
+public:
+    // SYSREQ_SNAPSHOT, else <app data location>/dxdiag_snapshot.json.
+    static QString defaultPath() {
+        QString path = qEnvironmentVariable("SYSREQ_SNAPSHOT");
+        if (path.isEmpty()) {
+            path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/dxdiag_snapshot.json";
+        }
+        return path;
+    }
+
+    static QByteArray rawHash(QByteArrayView bytes) {
+        return QCryptographicHash::hash(bytes, QCryptographicHash::Sha1);
+    }
+
+    static QByteArray fingerprint(const DxDiagReport& report, int section) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(report.sectionName(section).toUtf8());
+        for (int i = 0; i < report.itemCount(section); ++i) {
+            hash.addData(QByteArrayView("\x1e"));
+            if (report.hasKey(section, i)) {
+                hash.addData(report.key(section, i).toUtf8());
+                hash.addData(QByteArrayView("\x1f"));
+            }
+            for (int v = 0; v < report.valueCount(section, i); ++v) {
+                hash.addData(report.value(section, i, v).toUtf8());
+                hash.addData(QByteArrayView("\x1f"));
+            }
+        }
+        return hash.result();
+    }
+
+    // Items are stored as arrays; whether the first element is a key is up
+    // to the section's schema.
+    bool load(const QString& path) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+        m_sections.clear();
+        for (const QJsonValue& value : root["sections"].toArray()) {
+            const QJsonObject obj = value.toObject();
+            const QString name = obj["name"].toString();
+            const DxDiagSectionSchema* schema = findDxDiagSection(name);
+            const bool keyed = !schema || schema->style == DxDiagSectionSchema::Style::Pairs;
+            DxDiagReport::Builder builder;
+            builder.beginSection(name);
+            for (const QJsonValue& item : obj["items"].toArray()) {
+                const QJsonArray fields = item.toArray();
+                builder.beginItem(keyed ? fields.at(0).toString() : QString());
+                for (qsizetype i = keyed ? 1 : 0; i < fields.size(); ++i) {
+                    builder.addValue(fields.at(i).toString());
+                }
+            }
+            DxDiagSectionSnapshot section;
+            section.data = builder.build();
+            section.rawHash = QByteArray::fromHex(obj["rawHash"].toString().toLatin1());
+            section.fingerprint = QByteArray::fromHex(obj["fingerprint"].toString().toLatin1());
+            m_sections.append(section);
+        }
+        m_capturedAt = QDateTime::fromMSecsSinceEpoch(qint64(root["capturedAt"].toDouble())).toUTC();
+        return !m_sections.isEmpty();
+    }
+
+    bool save(const QString& path) const {
+        QJsonArray sections;
+        for (const DxDiagSectionSnapshot& section : m_sections) {
+            const DxDiagReport& data = section.data;
+            QJsonArray items;
+            for (int i = 0; i < data.itemCount(0); ++i) {
+                QJsonArray fields;
+                if (data.hasKey(0, i)) fields.append(data.key(0, i).toString());
+                for (int v = 0; v < data.valueCount(0, i); ++v) fields.append(data.value(0, i, v).toString());
+                items.append(fields);
+            }
+            QJsonObject obj;
+            obj["name"] = section.name().toString();
+            obj["items"] = items;
+            obj["rawHash"] = QString::fromLatin1(section.rawHash.toHex());
+            obj["fingerprint"] = QString::fromLatin1(section.fingerprint.toHex());
+            sections.append(obj);
+        }
+        QJsonObject root;
+        root["capturedAt"] = double(m_capturedAt.toMSecsSinceEpoch());
+        root["sections"] = sections;
+
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qDebug() << "Could not write dxdiag snapshot:" << path;
+            return false;
+        }
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        return file.commit();
+    }
+
+    const QList<DxDiagSectionSnapshot>& sections() const { return m_sections; }
+    QDateTime capturedAt() const { return m_capturedAt; }
+
+    DxDiagReport report() const {
+        DxDiagReport::Builder builder;
+        for (const DxDiagSectionSnapshot& section : m_sections) {
+            builder.appendSection(section.data, 0);
+        }
+        return builder.build();
+    }
+
+    const DxDiagSectionSnapshot* find(QStringView name) const {
+        for (const DxDiagSectionSnapshot& section : m_sections) {
+            if (section.name() == name) return &section;
+        }
+        return nullptr;
+    }
+
+    // Brings the snapshot up to date with `report` and returns the names of
+    // the sections whose fingerprint changed, appeared or disappeared.
+    // Sections whose bytes are unchanged are taken from the snapshot
+    // without being parsed. `step` is told how many of the report's sections
+    // are done; returning false abandons the refresh, leaving the snapshot
+    // as it was.
+    QStringList refresh(DxDiagLazyReport& report, const QList<DxDiagSectionSchema>& schema = dxDiagSchema(),
+                        const std::function<bool(int done, int total)>& step = {}) {
+        QList<DxDiagSectionSnapshot> sections;
+        int reparsed = 0;
+        int done = 0;
+        for (const DxDiagLazyReport::SectionSpan& span : report.spans()) {
+            if (step && !step(done++, int(report.spans().size()))) {
+                return {};
+            }
+            for (const DxDiagSectionSchema& section : schema) {
+                if ((report.format() == DxDiagCaptureFormat::Xml ? section.element : section.textSection) != span.name) continue;
+                const DxDiagSectionSnapshot* previous = find(section.element);
+                DxDiagSectionSnapshot current;
+                current.rawHash = rawHash(report.bytes(section));
+                if (previous && previous->rawHash == current.rawHash) {
+                    sections.append(*previous);
+                    break;
+                }
+                const DxDiagReport* data = report.section(section);
+                if (!data) break;
+                ++reparsed;
+                current.data = *data;
+                current.fingerprint = fingerprint(current.data, 0);
+                sections.append(current);
+                break;
+            }
+        }
+        qDebug() << "Snapshot refresh: reparsed" << reparsed << "of" << sections.size() << "sections";
+        return replace(sections);
+    }
+
+    // The same for sections that did not come from a report, such as a
+    // native hardware probe's.
+    QStringList refresh(const DxDiagReport& report) {
+        QList<DxDiagSectionSnapshot> sections;
+        for (int i = 0; i < report.sectionCount(); ++i) {
+            DxDiagReport::Builder builder;
+            builder.appendSection(report, i);
+            sections.append({builder.build(), QByteArray(), fingerprint(report, i)});
+        }
+        return replace(sections);
+    }
+
+private:
+    QStringList replace(const QList<DxDiagSectionSnapshot>& sections) {
+        QStringList changed;
+        for (const DxDiagSectionSnapshot& section : sections) {
+            const DxDiagSectionSnapshot* previous = find(section.name());
+            if (!previous || previous->fingerprint != section.fingerprint) {
+                changed.append(section.name().toString());
+            }
+        }
+        for (const DxDiagSectionSnapshot& section : m_sections) {
+            bool present = false;
+            for (const DxDiagSectionSnapshot& current : sections) {
+                present = present || current.name() == section.name();
+            }
+            if (!present) changed.append(section.name().toString());
+        }
+        qDebug() << "Snapshot sections changed:" << changed;
+        m_sections = sections;
+        m_capturedAt = QDateTime::currentDateTimeUtc();
+        return changed;
+    }
+
+    QList<DxDiagSectionSnapshot> m_sections;
+    QDateTime m_capturedAt;
+};
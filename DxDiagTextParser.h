@@ -0,0 +1,137 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFileDevice>
+#include <QIODevice>
+#include <QList>
+#include <QString>
+#include <QStringDecoder>
+#include <optional>
+#include <string_view>
+#include "DxDiagParser.h"
+#include "DxDiagTextScanner.h"
+
+
+// dxdiag /t writes the ANSI code page on most systems and UTF-16 with a BOM
+// on some. Values that are not valid UTF-8 are read as Latin-1.
+inline void appendDxDiagValue(DxDiagRecordBuilder& builder, std::string_view value) {
+    const QLatin1StringView latin1(value.data(), qsizetype(value.size()));
+    bool ascii = true;
+    for (char c : value) {
+        if (static_cast<unsigned char>(c) >= 0x80) {
+            ascii = false;
+            break;
+        }
+    }
+    if (ascii) {
+        builder.appendValue(latin1);
+        return;
+    }
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    const QString text = decoder.decode(QByteArrayView(value.data(), qsizetype(value.size())));
+    if (decoder.hasError()) {
+        builder.appendValue(latin1);
+    } else {
+        builder.appendValue(QStringView(text));
+    }
+}
+
+inline bool isDxDiagUtf16(const char* data, qint64 size) {
+    return size >= 2 && ((uchar(data[0]) == 0xFF && uchar(data[1]) == 0xFE) || (uchar(data[0]) == 0xFE && uchar(data[1]) == 0xFF));
+}
+
+inline QByteArray dxdiagUtf16ToUtf8(QByteArrayView data) {
+    QStringDecoder decoder(QStringDecoder::Utf16);
+    return QString(decoder.decode(data)).toUtf8();
+}
+
+// Parses an in-memory dxdiag /t report (single-byte or UTF-8) into the same
+// section model as parseDxDiagXml(). Keys and section titles are matched
+// against the schema in place; only the values that are kept are copied,
+// straight into the report's arena.
+// A record in a multi-record section starts when its first field repeats.
+inline bool parseDxDiagText(const char* data, std::size_t size, DxDiagReport::Builder& report, QString& errorMessage,
+                            const QList<DxDiagSectionSchema>& schema = dxDiagSchema()) {
+    if (size >= 3 && std::string_view(data, 3) == "\xEF\xBB\xBF") {
+        data += 3;
+        size -= 3;
+    }
+    std::optional<DxDiagRecordBuilder> builder;
+    bool sawBanner = false;
+    auto finishSection = [&]() {
+        if (!builder) return;
+        if (builder->hasPendingRecord()) builder->flushRecord();
+        builder.reset();
+    };
+
+    dxdiagScanText(data, size,
+        [&](std::string_view title) {
+            finishSection();
+            sawBanner = true;
+            const QLatin1StringView name(title.data(), qsizetype(title.size()));
+            for (const DxDiagSectionSchema& section : schema) {
+                if (section.textSection == name) {
+                    builder.emplace(report, section);
+                    break;
+                }
+            }
+        },
+        [&](std::string_view key, std::string_view value) {
+            if (!builder) return;
+            int field = builder->textFieldIndex(QLatin1StringView(key.data(), qsizetype(key.size())));
+            if (field < 0) return;
+            if (field == 0 && !builder->schema().recordElement.isEmpty() && builder->hasPendingRecord()) {
+                builder->flushRecord();
+            }
+            if (builder->beginValue(field)) {
+                appendDxDiagValue(*builder, value);
+                builder->endValue();
+            }
+        });
+    finishSection();
+
+    if (!sawBanner) {
+        errorMessage = "No dxdiag section banners found in text report.";
+        return false;
+    }
+    return true;
+}
+
+// Files are memory-mapped rather than read; other devices are read whole.
+// UTF-16 reports are converted to UTF-8 first.
+inline bool parseDxDiagText(QIODevice* device, DxDiagReport::Builder& report, QString& errorMessage,
+                            const QList<DxDiagSectionSchema>& schema = dxDiagSchema()) {
+    QByteArray buffer;
+    const char* data = nullptr;
+    qint64 size = 0;
+    uchar* mapped = nullptr;
+    QFileDevice* file = qobject_cast<QFileDevice*>(device);
+    if (file && file->size() > 0) {
+        mapped = file->map(0, file->size());
+    }
+    if (mapped) {
+        data = reinterpret_cast<const char*>(mapped);
+        size = file->size();
+    } else {
+        buffer = device->readAll();
+        data = buffer.constData();
+        size = buffer.size();
+    }
+
+    if (isDxDiagUtf16(data, size)) {
+        QByteArray utf8 = dxdiagUtf16ToUtf8(QByteArrayView(data, size));
+        if (mapped) {
+            file->unmap(mapped);
+            mapped = nullptr;
+        }
+        buffer = std::move(utf8);
+        data = buffer.constData();
+        size = buffer.size();
+    }
+
+    const bool ok = parseDxDiagText(data, std::size_t(size), report, errorMessage, schema);
+    if (mapped) {
+        file->unmap(mapped);
+    }
+    return ok;
+}
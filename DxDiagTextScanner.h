@@ -0,0 +1,189 @@
+#pragma once
+
+// Tokenizer for dxdiag /t reports. Shared by DxDiagTextParser.h and
+// test.cpp, so it only depends on the standard library.
+//
+// A report is a sequence of sections:
+//
+//   ------------------
+//   System Information
+//   ------------------
+//         Machine name: DESKTOP-9KIG4I8
+//
+// The scanner walks a byte buffer once, finding line breaks and the first
+// ':' of each line 16 bytes at a time, and hands out std::string_view
+// slices of the input; nothing is copied.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DXDIAG_TEXT_SCANNER_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+
+inline constexpr std::size_t DxDiagNoColon = std::size_t(-1);
+
+#if defined(DXDIAG_TEXT_SCANNER_SSE2)
+inline unsigned dxdiagLowestBit(uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return unsigned(index);
+#else
+    return unsigned(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+// Calls onLine(line, colon) for every line of data, without the line break.
+// colon is the offset of the first ':' in line, or DxDiagNoColon.
+template <typename OnLine>
+void dxdiagScanLines(const char* data, std::size_t size, OnLine&& onLine) {
+    std::size_t lineStart = 0;
+    std::size_t colon = DxDiagNoColon;
+    std::size_t i = 0;
+    auto emit = [&](std::size_t lineEnd) {
+        onLine(std::string_view(data + lineStart, lineEnd - lineStart),
+               colon == DxDiagNoColon ? DxDiagNoColon : colon - lineStart);
+        lineStart = lineEnd + 1;
+        colon = DxDiagNoColon;
+    };
+
+#if defined(DXDIAG_TEXT_SCANNER_SSE2)
+    const __m128i newlines = _mm_set1_epi8('\n');
+    const __m128i colons = _mm_set1_epi8(':');
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        uint32_t newlineMask = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newlines)));
+        uint32_t colonMask = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, colons)));
+        while (newlineMask != 0) {
+            const unsigned bit = dxdiagLowestBit(newlineMask);
+            const uint32_t before = colonMask & ((1u << bit) - 1);
+            if (colon == DxDiagNoColon && before != 0) {
+                colon = i + dxdiagLowestBit(before);
+            }
+            emit(i + bit);
+            colonMask &= ~((2u << bit) - 1);
+            newlineMask &= newlineMask - 1;
+        }
+        if (colon == DxDiagNoColon && colonMask != 0) {
+            colon = i + dxdiagLowestBit(colonMask);
+        }
+    }
+#endif
+
+    while (i < size) {
+        const char* newline = static_cast<const char*>(std::memchr(data + i, '\n', size - i));
+        const std::size_t lineEnd = newline ? std::size_t(newline - data) : size;
+        if (colon == DxDiagNoColon) {
+            const char* found = static_cast<const char*>(std::memchr(data + i, ':', lineEnd - i));
+            if (found) colon = std::size_t(found - data);
+        }
+        if (!newline) {
+            i = size;
+            break;
+        }
+        emit(lineEnd);
+        i = lineEnd + 1;
+    }
+    if (lineStart < size) {
+        emit(size);
+    }
+}
+
+inline std::string_view dxdiagTrim(std::string_view text) {
+    std::size_t begin = 0, end = text.size();
+    while (begin < end && (text[begin] == ' ' || text[begin] == '\t' || text[begin] == '\r')) ++begin;
+    while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t' || text[end - 1] == '\r')) --end;
+    return text.substr(begin, end - begin);
+}
+
+inline bool dxdiagIsBannerRule(std::string_view line) {
+    line = dxdiagTrim(line);
+    if (line.size() < 3) return false;
+    for (char c : line) {
+        if (c != '-') return false;
+    }
+    return true;
+}
+
+// Splits a report into events: onSection(title) at each "---/Title/---"
+// banner and onField(key, value) for each "Key: Value" line, both trimmed.
+// Lines without a colon are ignored.
+template <typename OnSection, typename OnField>
+void dxdiagScanText(const char* data, std::size_t size, OnSection&& onSection, OnField&& onField) {
+    enum class State { Body, AfterRule, AfterTitle };
+    State state = State::Body;
+    std::string_view title;
+    std::size_t titleColon = DxDiagNoColon;
+
+    auto field = [&](std::string_view line, std::size_t colon) {
+        if (colon == DxDiagNoColon || colon == 0) return;
+        std::string_view key = dxdiagTrim(line.substr(0, colon));
+        if (!key.empty()) {
+            onField(key, dxdiagTrim(line.substr(colon + 1)));
+        }
+    };
+
+    dxdiagScanLines(data, size, [&](std::string_view line, std::size_t colon) {
+        if (dxdiagIsBannerRule(line)) {
+            if (state == State::AfterTitle) {
+                onSection(title);
+                state = State::Body;
+            } else {
+                state = State::AfterRule;
+            }
+            return;
+        }
+        if (state == State::AfterTitle) {
+            field(title, titleColon);  // not a banner after all
+            state = State::Body;
+        }
+        if (state == State::AfterRule && !dxdiagTrim(line).empty()) {
+            title = dxdiagTrim(line);
+            titleColon = colon == DxDiagNoColon ? DxDiagNoColon : colon - std::size_t(title.data() - line.data());
+            state = State::AfterTitle;
+            return;
+        }
+        state = State::Body;
+        field(line, colon);
+    });
+    if (state == State::AfterTitle) {
+        field(title, titleColon);
+    }
+}
+
+// Pre-pass for lazy loading: calls onBanner(title, offset) for each section
+// banner, with offset pointing at the banner's first rule. Only lines that
+// start with '-' are examined, so body lines cost one memchr each.
+template <typename OnBanner>
+void dxdiagScanBanners(const char* data, std::size_t size, OnBanner&& onBanner) {
+    auto lineEnd = [&](std::size_t from) {
+        const char* newline = static_cast<const char*>(std::memchr(data + from, '\n', size - from));
+        return newline ? std::size_t(newline - data) : size;
+    };
+    std::size_t pos = 0;
+    while (pos < size) {
+        const std::size_t end = lineEnd(pos);
+        if (data[pos] == '-' && dxdiagIsBannerRule(std::string_view(data + pos, end - pos)) && end < size) {
+            const std::size_t titleEnd = lineEnd(end + 1);
+            const std::string_view title = dxdiagTrim(std::string_view(data + end + 1, titleEnd - end - 1));
+            if (titleEnd < size && !title.empty()) {
+                const std::size_t ruleEnd = lineEnd(titleEnd + 1);
+                if (dxdiagIsBannerRule(std::string_view(data + titleEnd + 1, ruleEnd - titleEnd - 1))) {
+                    onBanner(title, pos);
+                    pos = ruleEnd + 1;
+                    continue;
+                }
+            }
+        }
+        pos = end + 1;
+    }
+}
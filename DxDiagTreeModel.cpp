@@ -0,0 +1 @@
+#include "DxDiagTreeModel.h"
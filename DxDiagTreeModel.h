@@ -0,0 +1,182 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QList>
+#include <QModelIndex>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <algorithm>
+#include "DxDiagReport.h"
+
+
+// The dxdiag report as a two-level model (sections, then their items) read
+// straight from the report's arena. Nothing is allocated per row, and a
+// section's rows are handed to the view in batches as it is expanded and
+// scrolled, so a report with every field costs what is on screen.
+//
+// A child's internal id is its section's row + 1; sections have id 0.
+// Keyed items show as {key, value}; composite records (one LogicalDisk:
+// "Drive: C:", "Free Space: ...") show their first value with the rest
+// joined after it.
+class DxDiagTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kFetchBatch = 256;
+
+    explicit DxDiagTreeModel(QObject *parent = nullptr) : QAbstractItemModel(parent) {}
+
+    const DxDiagReport &report() const { return m_report; }
+
+    // Replaces the report. If the sections are the same ones in the same
+    // order, only those in `changed` are rebuilt and the view keeps the
+    // rest, expansion included; otherwise (or with `all`) the model is
+    // reset. Returns the rows of the sections that were rebuilt.
+    QList<int> setReport(const DxDiagReport &report, const QStringList &changed, bool all)
+    {
+        bool sameLayout = !all && report.sectionCount() == m_report.sectionCount();
+        for (int i = 0; sameLayout && i < report.sectionCount(); ++i) {
+            sameLayout = report.sectionName(i) == m_report.sectionName(i);
+        }
+
+        QList<int> rebuilt;
+        if (!sameLayout) {
+            beginResetModel();
+            m_report = report;
+            m_loaded = QList<int>(report.sectionCount(), 0);
+            endResetModel();
+            for (int row = 0; row < m_report.sectionCount(); ++row) {
+                rebuilt.append(row);
+            }
+            return rebuilt;
+        }
+
+        // Unchanged sections hold the same items in the new report.
+        for (int row = 0; row < report.sectionCount(); ++row) {
+            if (!changed.contains(report.sectionName(row))) {
+                continue;
+            }
+            const QModelIndex section = index(row, 0);
+            if (m_loaded.at(row) > 0) {
+                beginRemoveRows(section, 0, m_loaded.at(row) - 1);
+                m_loaded[row] = 0;
+                endRemoveRows();
+            }
+            rebuilt.append(row);
+        }
+        m_report = report;
+        for (int row : rebuilt) {
+            // An expanded section is not fetched again by the view.
+            fetchMore(index(row, 0));
+            emit dataChanged(index(row, 0), index(row, 1));
+        }
+        return rebuilt;
+    }
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override
+    {
+        if (!hasIndex(row, column, parent)) {
+            return QModelIndex();
+        }
+        if (!parent.isValid()) {
+            return createIndex(row, column, quintptr(0));
+        }
+        return createIndex(row, column, quintptr(parent.row() + 1));
+    }
+
+    QModelIndex parent(const QModelIndex &child) const override
+    {
+        if (!child.isValid() || child.internalId() == 0) {
+            return QModelIndex();
+        }
+        return createIndex(int(child.internalId() - 1), 0, quintptr(0));
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        if (!parent.isValid()) {
+            return m_report.sectionCount();
+        }
+        return isSection(parent) ? m_loaded.at(parent.row()) : 0;
+    }
+
+    int columnCount(const QModelIndex & = QModelIndex()) const override { return 2; }
+
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override
+    {
+        if (!parent.isValid()) {
+            return !m_report.isEmpty();
+        }
+        return isSection(parent) && m_report.itemCount(parent.row()) > 0;
+    }
+
+    bool canFetchMore(const QModelIndex &parent) const override
+    {
+        return isSection(parent) && m_loaded.at(parent.row()) < m_report.itemCount(parent.row());
+    }
+
+    void fetchMore(const QModelIndex &parent) override
+    {
+        if (!canFetchMore(parent)) {
+            return;
+        }
+        const int row = parent.row();
+        const int loaded = m_loaded.at(row);
+        const int count = std::min(kFetchBatch, m_report.itemCount(row) - loaded);
+        beginInsertRows(parent, loaded, loaded + count - 1);
+        m_loaded[row] = loaded + count;
+        endInsertRows();
+    }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override
+    {
+        if (!index.isValid()) {
+            return QVariant();
+        }
+        if (isSection(index)) {
+            const int section = index.row();
+            if (role == Qt::UserRole) {
+                return m_report.sectionName(section).toString();
+            }
+            if (role != Qt::DisplayRole || index.column() != 0) {
+                return QVariant();
+            }
+            return (m_report.itemCount(section) == 0 ? "🔴 " : "🟢 ") + m_report.sectionName(section).toString();
+        }
+        if (role != Qt::DisplayRole) {
+            return QVariant();
+        }
+        const int section = int(index.internalId() - 1);
+        const int item = index.row();
+        const int values = m_report.valueCount(section, item);
+        if (m_report.hasKey(section, item)) {
+            return index.column() == 0 ? m_report.key(section, item).toString()
+                                       : (values > 0 ? m_report.value(section, item, 0).toString() : QString());
+        }
+        if (index.column() == 0) {
+            return values > 0 ? m_report.value(section, item, 0).toString() : QString();
+        }
+        QString details;
+        for (int v = 1; v < values; ++v) {
+            if (v > 1) details += u", ";
+            details += m_report.value(section, item, v);
+        }
+        return details;
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override
+    {
+        if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+            return QVariant();
+        }
+        return section == 0 ? QStringLiteral("Item") : QStringLiteral("Details");
+    }
+
+private:
+    static bool isSection(const QModelIndex &index) { return index.isValid() && index.internalId() == 0 && index.column() == 0; }
+
+    DxDiagReport m_report;
+    QList<int> m_loaded;  // rows handed to the view, per section
+};
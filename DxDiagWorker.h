@@ -4,260 +4,330 @@
 #include <QString>
 #include <QStringList>
 #include <QFile>
-#include <QTextStream>
+#include <QFileInfo>
 #include <QDebug>
-#include <thread>
-#include <chrono>
-#include <fstream>
+#include <QElapsedTimer>
+#include <QPointer>
 #include <QProcess>
-#include <QXmlStreamReader>
-
-
-struct DxDiagSectionData {
-    QString sectionName;
-    QList<QStringList> items;
+#include <QTimer>
+#include <functional>
+#include <optional>
+#include "DxDiagParser.h"
+#include "DxDiagReport.h"
+#include "DxDiagSnapshot.h"
+#include "HardwareProbe.h"
+#include "TaskScheduler.h"
+#include "Trace.h"
+
+// changedSections lists the sections that differ from the snapshot; with
+// no snapshot path set, every section. The report is frozen on the pool
+// thread, so delivering it anywhere afterwards copies one pointer.
+struct DxDiagCaptureResult {
+    bool ok = false;
+    DxDiagReport report;
+    QStringList changedSections;
+    QString error;
 };
 
-Q_DECLARE_METATYPE(DxDiagSectionData)
-Q_DECLARE_METATYPE(QList<DxDiagSectionData>)
-
+// One capture, driven by events on the scheduler's event thread. A native
+// probe runs as a pool job; failing that, dxdiag.exe is started without
+// waiting on it, its report file is watched while it is written, and it is
+// killed at the deadline. The report is then parsed as a pool job. cancel()
+// stops whichever step is running, and finished() always comes last, once.
 class DxDiagWorker : public QObject
 {
     Q_OBJECT
 
 public:
-    DxDiagWorker(QObject *parent = nullptr) : QObject(parent) { qDebug() << "DxDiagWorker created"; }
+    enum class Stage {
+        Launching,
+        Writing,
+        Parsing
+    };
+    Q_ENUM(Stage)
 
-    ~DxDiagWorker() override { qDebug() << "DxDiagWorker destroyed"; }
+    DxDiagWorker(QObject *parent = nullptr) : QObject(parent) { qDebug() << "DxDiagWorker created"; }
 
-public slots:
-    void processDxDiag()
+    // A dxdiag.exe still running is killed along with m_process.
+    ~DxDiagWorker() override
     {
-        qDebug() << "DxDiagWorker::processDxDiag started";
-        emit started();
-        qDebug() << "DxDiagWorker::started() emitted";
+        m_token.cancel();
+        qDebug() << "DxDiagWorker destroyed";
+    }
 
-        
-        QString outputFile = "dxdiag_output.xml";
-        QString program = "dxdiag.exe";
-        QStringList arguments;
-        arguments << "/x" << outputFile;
+    // Parse an existing /x or /t capture instead of running dxdiag.exe.
+    void setInputFile(const QString &path) { m_inputFile = path; }
 
-        qDebug() << "Running command:" << program << arguments;
-        QProcess dxdiagProcess;
-        dxdiagProcess.start(program, arguments);
-        dxdiagProcess.waitForFinished(-1); 
+    // Compare the result against, and update, the snapshot at `path`.
+    void setSnapshotPath(const QString &path) { m_snapshotPath = path; }
 
-        if (dxdiagProcess.exitCode() != 0) {
-            qDebug() << "Error running dxdiag.exe:";
-            qDebug() << dxdiagProcess.readAllStandardError();
-            emit error("Failed to run dxdiag.exe");
-            emit finished();
-            return;
+    void setPriority(TaskPriority priority) { m_priority = priority; }
+    void setTimeout(int timeoutMs) { m_timeoutMs = timeoutMs; }
+
+    // Loads the report at `path` on the calling thread, reporting parse
+    // progress in percent. Stops early once `token` is cancelled.
+    static DxDiagCaptureResult parseCapture(const QString &path, const QString &snapshotPath, const CancellationToken &token,
+                                            const std::function<void(int percent)> &progress)
+    {
+        SYSREQ_TRACE_SCOPE("dxdiag parse");
+        DxDiagCaptureResult result;
+        QElapsedTimer parseTimer;
+        parseTimer.start();
+        DxDiagLazyReport report;
+        if (!report.open(path, result.error)) {
+            qDebug() << "Error:" << result.error;
+            return result;
         }
-        qDebug() << "dxdiag.exe finished successfully.";
+        int lastPercent = -1;
+        auto step = [&](int done, int total) {
+            const int percent = total > 0 ? done * 100 / total : 100;
+            if (percent != lastPercent) {
+                lastPercent = percent;
+                progress(percent);
+            }
+            return !token.isCancelled();
+        };
 
-        
-        QFile file(outputFile);
-        QList<DxDiagSectionData> sectionsData;
+        if (snapshotPath.isEmpty()) {
+            result.report = report.toReport(dxDiagSchema(), step);
+            for (int i = 0; i < result.report.sectionCount(); ++i) {
+                result.changedSections.append(result.report.sectionName(i).toString());
+            }
+        } else {
+            DxDiagSnapshot snapshot;
+            snapshot.load(snapshotPath);
+            result.changedSections = snapshot.refresh(report, dxDiagSchema(), step);
+            if (!token.isCancelled()) {
+                snapshot.save(snapshotPath);
+                result.report = snapshot.report();
+            }
+        }
+        if (token.isCancelled()) {
+            result.error = QStringLiteral("Cancelled");
+            return result;
+        }
+        SYSREQ_TRACE_COUNTER("report bytes", result.report.memoryUsage());
+        progress(100);
+        result.ok = true;
+        qDebug() << "Finished parsing" << path << "in" << parseTimer.elapsed() << "ms";
+        return result;
+    }
 
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            qDebug() << "Error: Could not open" << outputFile;
-            emit error("Could not open " + outputFile);
-            emit finished();
-            qDebug() << "DxDiagWorker::error() and finished() emitted due to file error";
+public slots:
+    void start()
+    {
+        if (m_finished) {
+            return;
+        }
+        qDebug() << "DxDiagWorker::start";
+        emit started();
+        if (!m_inputFile.isEmpty()) {
+            qDebug() << "Loading dxdiag capture" << m_inputFile;
+            startParse(m_inputFile);
             return;
         }
 
-        qDebug() << "File" << outputFile << "opened successfully";
-        QXmlStreamReader xml(&file);
-
-        
-        if (xml.readNextStartElement() && xml.name() == "DxDiag") {
-            qDebug() << "Found DxDiag root element.";
-
-            
-            while (!xml.atEnd() && !xml.hasError()) {
-                QXmlStreamReader::TokenType token = xml.readNext();
-
-                if (token == QXmlStreamReader::StartElement) {
-                    QString elementName = xml.name().toString();
-
-                    if (elementName == "SystemInformation") {
-                        qDebug() << "Started parsing SystemInformation section.";
-                        DxDiagSectionData systemInfoSection;
-                        systemInfoSection.sectionName = "SystemInformation";
-
-                        while (!xml.atEnd() && !xml.hasError() && !(xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "SystemInformation")) {
-                            if (xml.readNext() == QXmlStreamReader::StartElement) {
-                                QString key = xml.name().toString();
-                                if (key == "Processor" || key == "Memory") {
-                                    QString value = xml.readElementText();
-                                    if (!value.isEmpty()) {
-                                        systemInfoSection.items.append({key, value});
-                                        qDebug() << "Extracted SystemInformation item:" << key << ":" << value;
-                                    }
-                                } else {
-                                    xml.skipCurrentElement(); 
-                                }
-                            }
-                        }
-                         
-                        if (xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "SystemInformation") {
-                             qDebug() << "Finished parsing SystemInformation section.";
-                             sectionsData.append(systemInfoSection);
-                             qDebug() << "Appended SystemInformation section with" << systemInfoSection.items.size() << "items. Total sections now:" << sectionsData.size();
-                        }
-
-                    } else if (elementName == "DisplayDevices") {
-                        qDebug() << "Started parsing DisplayDevices section.";
-                        DxDiagSectionData displayDevicesSection;
-                        displayDevicesSection.sectionName = "DisplayDevices";
+        emit progress(Stage::Launching, -1);
+        const QString snapshotPath = m_snapshotPath;
+        const CancellationToken token = m_token;
+        TaskScheduler::instance().run(m_priority, m_token, [snapshotPath, token]() -> std::optional<DxDiagCaptureResult> {
+            SYSREQ_TRACE_SCOPE("hardware probe");
+            for (const std::unique_ptr<HardwareProbe> &probe : createNativeHardwareProbes()) {
+                qDebug() << "Probing hardware with" << probe->name();
+                HardwareProbeResult probed;
+                QString probeError;
+                if (!probe->probe(probed, probeError)) {
+                    qDebug() << probe->name() << "failed:" << probeError;
+                    continue;
+                }
+                if (!probed.captureFile.isEmpty()) {
+                    return parseCapture(probed.captureFile, snapshotPath, token, [](int) {});
+                }
+                DxDiagCaptureResult result;
+                result.ok = true;
+                result.report = probed.report;
+                result.changedSections = refreshSnapshot(snapshotPath, probed.report);
+                return result;
+            }
+            return std::nullopt;
+        }).then(this, [this](const std::optional<DxDiagCaptureResult> &result) {
+            if (result) {
+                finish(*result);
+            } else {
+                launchDxDiag();
+            }
+        });
+    }
 
-                        
-                        while (!xml.atEnd() && !xml.hasError() && !(xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "DisplayDevices")) {
-                            if (xml.readNext() == QXmlStreamReader::StartElement) {
-                                if (xml.name() == "DisplayDevice") {
-                                    qDebug() << "Found nested DisplayDevice.";
-                                    
-                                    while (!xml.atEnd() && !xml.hasError() && !(xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "DisplayDevice")) {
-                                        if (xml.readNext() == QXmlStreamReader::StartElement) {
-                                            QString itemKey = xml.name().toString();
-                                            if (itemKey == "CardName" || itemKey == "CurrentMode") {
-                                                QString itemValue = xml.readElementText();
-                                                if (!itemValue.isEmpty()) {
-                                                     displayDevicesSection.items.append({itemKey, itemValue});
-                                                     qDebug() << "Extracted DisplayDevices item:" << itemKey << ":" << itemValue;
-                                                }
-                                            } else {
-                                                xml.skipCurrentElement(); 
-                                            }
-                                        }
-                                    }
-                                    
-                                    if (xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "DisplayDevice") {
-                                        qDebug() << "Finished parsing nested DisplayDevice.";
-                                    }
-                                } else {
-                                    xml.skipCurrentElement(); 
-                                }
-                            }
-                        }
-                         
-                        if (xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "DisplayDevices") {
-                             qDebug() << "Finished parsing DisplayDevices section.";
-                             sectionsData.append(displayDevicesSection);
-                             qDebug() << "Appended DisplayDevices section with" << displayDevicesSection.items.size() << "items. Total sections now:" << sectionsData.size();
-                        }
+    void cancel()
+    {
+        if (m_finished) {
+            return;
+        }
+        qDebug() << "DxDiag capture cancelled";
+        m_token.cancel();
+        stopProcess();
+        m_finished = true;
+        emit finished();
+    }
 
-                    } else if (elementName == "LogicalDisks") {
-                        qDebug() << "Started parsing LogicalDisks section.";
-                        DxDiagSectionData logicalDisksSection;
-                        logicalDisksSection.sectionName = "LogicalDisks";
+signals:
+    void started();
+    // percent is -1 while it cannot be estimated (dxdiag.exe running).
+    void progress(DxDiagWorker::Stage stage, int percent);
+    void finished();
+    void error(const QString &message);
+    // changedSections lists the sections that differ from the snapshot; with
+    // no snapshot path set, every section.
+    void parsingFinished(const DxDiagReport &report, const QStringList &changedSections);
 
-                        
-                        while (!xml.atEnd() && !xml.hasError() && !(xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "LogicalDisks")) {
-                            if (xml.readNext() == QXmlStreamReader::StartElement) {
-                                if (xml.name() == "LogicalDisk") {
-                                    qDebug() << "Found nested LogicalDisk.";
-                                    QString drive = "N/A";
-                                    QString freeSpace = "N/A";
-                                    QString size = "N/A";
+private:
+    void launchDxDiag()
+    {
+        if (m_finished) {
+            return;
+        }
+        DxDiagHardwareProbe dxdiag;
+        m_outputFile = dxdiag.outputFile();
+        // A report left by an earlier run must not pass for this one's.
+        QFile::remove(m_outputFile);
+
+        qDebug() << "Running command:" << DxDiagHardwareProbe::program() << dxdiag.arguments();
+        m_process = new QProcess(this);
+        connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError processError) {
+            if (processError == QProcess::FailedToStart) {
+                fail(QStringLiteral("Failed to run dxdiag.exe"));
+            }
+        });
+        connect(m_process, &QProcess::finished, this, &DxDiagWorker::onDxDiagFinished);
+
+        m_deadline = new QTimer(this);
+        m_deadline->setSingleShot(true);
+        connect(m_deadline, &QTimer::timeout, this, [this]() {
+            qDebug() << "dxdiag.exe hit the" << m_timeoutMs << "ms deadline, killing it";
+            fail("dxdiag.exe did not finish within " + QString::number(m_timeoutMs / 1000) + " s");
+        });
+        m_deadline->start(m_timeoutMs);
+
+        // dxdiag writes the whole report at the end of its run.
+        m_poll = new QTimer(this);
+        connect(m_poll, &QTimer::timeout, this, [this]() {
+            if (!m_writing && QFileInfo(m_outputFile).size() > 0) {
+                m_writing = true;
+                emit progress(Stage::Writing, -1);
+            }
+        });
+        m_poll->start(250);
 
-                                    
-                                    while (!xml.atEnd() && !xml.hasError() && !(xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "LogicalDisk")) {
-                                         if (xml.readNext() == QXmlStreamReader::StartElement) {
-                                            QString itemKey = xml.name().toString();
-                                            QString itemValue = xml.readElementText();
+        m_launchBegin = Trace::now();
+        m_process->start(DxDiagHardwareProbe::program(), dxdiag.arguments());
+    }
 
-                                            if (itemKey == "DriveLetter") {
-                                                drive = itemValue;
-                                                qDebug() << "Extracted DriveLetter:" << drive;
-                                            } else if (itemKey == "FreeSpace") {
-                                                freeSpace = itemValue;
-                                                qDebug() << "Extracted FreeSpace:" << freeSpace;
-                                            } else if (itemKey == "MaxSpace") {
-                                                size = itemValue;
-                                                qDebug() << "Extracted MaxSpace:" << size;
-                                            }
-                                        }
-                                    }
-                                    
-                                    if (xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "LogicalDisk") {
-                                        qDebug() << "Finished parsing nested LogicalDisk.";
-                                        
-                                        logicalDisksSection.items.append({"Drive: " + drive, "Free Space: " + freeSpace, "Size: " + size});
-                                        qDebug() << "Added LogicalDisk item with" << logicalDisksSection.items.last().size() << "parts.";
-                                    }
-                                }
-                            }
-                        }
-                        
-                        if (xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "LogicalDisks") {
-                             qDebug() << "Finished parsing LogicalDisks section.";
-                             sectionsData.append(logicalDisksSection);
-                             qDebug() << "Appended LogicalDisks section with" << logicalDisksSection.items.size() << "items.";
-                        }
+    void onDxDiagFinished(int exitCode, QProcess::ExitStatus exitStatus)
+    {
+        Trace::complete("dxdiag launch", m_launchBegin);
+        stopTimers();
+        if (m_finished) {
+            return;
+        }
+        if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+            qDebug() << "Error running dxdiag.exe:" << m_process->readAllStandardError();
+            fail(QStringLiteral("Failed to run dxdiag.exe"));
+            return;
+        }
+        qDebug() << "dxdiag.exe finished successfully.";
+        startParse(m_outputFile);
+    }
 
-                    } else {
-                        xml.skipCurrentElement(); 
-                         qDebug() << "Skipping section:" << elementName;
-                    }
+    void startParse(const QString &path)
+    {
+        emit progress(Stage::Parsing, 0);
+        // The job reports back through a guarded pointer, so the worker may
+        // be deleted while it runs.
+        const QPointer<QObject> self(this);
+        QThread *thread = this->thread();
+        auto report = [self, thread](int percent) {
+            invokeOnContext(self, thread, [self, percent]() {
+                emit static_cast<DxDiagWorker *>(self.data())->progress(Stage::Parsing, percent);
+            });
+        };
+        const QString snapshotPath = m_snapshotPath;
+        const CancellationToken token = m_token;
+        TaskScheduler::instance().run(m_priority, m_token, [path, snapshotPath, token, report]() {
+            return parseCapture(path, snapshotPath, token, report);
+        }).then(this, [this](const DxDiagCaptureResult &result) { finish(result); });
+    }
 
-                } else if (token == QXmlStreamReader::EndElement && xml.name() == "DxDiag") {
-                     qDebug() << "Finished parsing DxDiag root element and main loop.";
-                     break; 
-                } else if (token == QXmlStreamReader::Characters && !xml.isWhitespace()) {
-                    
-                    qDebug() << "Ignoring unexpected character data:" << xml.text();
-                } else if (token != QXmlStreamReader::Characters && !xml.isWhitespace()) {
-                    
-                    qDebug() << "Skipping unexpected token between sections: type" << token << ", name:" << xml.name();
-                    xml.skipCurrentElement(); 
-                }
-                
-            }
-        } else {
-            qDebug() << "Error: Could not find DxDiag root element.";
-            emit error("Could not find DxDiag root element in XML.");
-            emit finished();
+    void finish(const DxDiagCaptureResult &result)
+    {
+        if (m_finished) {
             return;
         }
-
-        if (xml.hasError()) {
-            qDebug() << "XML parsing error:" << xml.errorString();
-            emit error("XML parsing error: " + xml.errorString());
+        m_finished = true;
+        if (!result.ok) {
+            emit error(result.error);
             emit finished();
             return;
         }
+        const DxDiagReport &report = result.report;
+        emit parsingFinished(report, result.changedSections);
+        qDebug() << "DxDiagWorker::parsingFinished() emitted with" << report.sectionCount() << "sections," << report.memoryUsage() << "bytes";
+        emit finished();
+    }
 
-        file.close();
-        qDebug() << "Finished parsing" << outputFile;
+    void fail(const QString &message)
+    {
+        stopProcess();
+        DxDiagCaptureResult result;
+        result.error = message;
+        finish(result);
+    }
 
-        
-        for (const auto& section : sectionsData) {
-            if (section.sectionName == "SystemInformation") { 
-                qDebug() << "Pre-emit - System Information items count:" << section.items.size();
-            } else if (section.sectionName == "DisplayDevices") { 
-                qDebug() << "Pre-emit - Display Devices items count:" << section.items.size();
-            } else if (section.sectionName == "LogicalDisks") { 
-                qDebug() << "Pre-emit - Logical Disks items count:" << section.items.size();
-            }
+    void stopTimers()
+    {
+        if (m_deadline) {
+            m_deadline->stop();
+        }
+        if (m_poll) {
+            m_poll->stop();
         }
+    }
 
-        qDebug() << "Before emitting parsingFinished, sectionsData size:" << sectionsData.size();
-        emit parsingFinished(sectionsData);
-        qDebug() << "DxDiagWorker::parsingFinished() emitted with" << sectionsData.size() << "sections";
-        emit finished();
-        qDebug() << "DxDiagWorker::finished() emitted";
+    // kill() is asynchronous; finished() then arrives and is ignored.
+    void stopProcess()
+    {
+        stopTimers();
+        if (m_process && m_process->state() != QProcess::NotRunning) {
+            m_process->kill();
+        }
     }
 
-signals:
-    void started();
-    void finished();
-    void error(const QString &message);
-    void parsingFinished(const QList<DxDiagSectionData> &sectionsData);
+    static QStringList refreshSnapshot(const QString &snapshotPath, const DxDiagReport &report)
+    {
+        QStringList changed;
+        if (snapshotPath.isEmpty()) {
+            for (int i = 0; i < report.sectionCount(); ++i) {
+                changed.append(report.sectionName(i).toString());
+            }
+            return changed;
+        }
+        DxDiagSnapshot snapshot;
+        snapshot.load(snapshotPath);
+        changed = snapshot.refresh(report);
+        snapshot.save(snapshotPath);
+        return changed;
+    }
 
-private:
-    
-}; 
\ No newline at end of file
+    QString m_inputFile;
+    QString m_snapshotPath;
+    QString m_outputFile;
+    TaskPriority m_priority = TaskPriority::Background;
+    int m_timeoutMs = dxdiagTimeoutMs();
+    CancellationToken m_token;
+    QProcess *m_process = nullptr;
+    Trace::Timestamp m_launchBegin;
+    QTimer *m_deadline = nullptr;
+    QTimer *m_poll = nullptr;
+    bool m_writing = false;
+    bool m_finished = false;
+};
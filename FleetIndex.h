@@ -0,0 +1,164 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <vector>
+#include "ComparisonEngine.h"
+#include "DxDiagIngest.h"
+#include "ParallelFor.h"
+
+
+// Many machines' normalized profiles, for the inverse of the GUI's query:
+// which machines meet a title's requirements? RAM, GPU tier and free storage
+// each have a sorted index, so every requirement maps to a range of
+// machines. The narrowest range is scanned, the other dimensions are
+// checked against the machine's profile, and compareProfiles() has the
+// final word, so the answer is exactly the machines the GUI would show as
+// meeting everything.
+class FleetIndex {
+public:
+    struct LoadResult {
+        int loaded = 0;
+        QStringList errors;
+    };
+
+    void clear() {
+        m_ids.clear();
+        m_profiles.clear();
+        m_ram.clear();
+        m_gpuTier.clear();
+        m_storage.clear();
+    }
+
+    void reserve(int count) {
+        m_ids.reserve(count);
+        m_profiles.reserve(std::size_t(count));
+    }
+
+    // The indexes are stale until build() runs.
+    int addMachine(const QString& id, const SystemProfile& profile) {
+        m_ids.append(id);
+        m_profiles.push_back(profile);
+        return int(m_profiles.size() - 1);
+    }
+
+    void build() {
+        auto index = [this](std::vector<Entry>& entries, qint32 SystemProfile::*field) {
+            entries.resize(m_profiles.size());
+            for (std::size_t i = 0; i < m_profiles.size(); ++i) {
+                entries[i] = {m_profiles[i].*field, qint32(i)};
+            }
+            std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+                return a.value != b.value ? a.value < b.value : a.machine < b.machine;
+            });
+        };
+        index(m_ram, &SystemProfile::ramMb);
+        index(m_gpuTier, &SystemProfile::gpuRank);
+        index(m_storage, &SystemProfile::storageMb);
+    }
+
+    // Adds every dxdiag capture under the given files/directories, parsed
+    // on `threads` workers, and rebuilds the indexes. Each capture's
+    // report is dropped once its profile is built.
+    LoadResult loadCaptures(const QStringList& inputs, int threads = defaultWorkerCount()) {
+        const QStringList paths = findDxDiagCaptures(inputs);
+        std::vector<SystemProfile> profiles(std::size_t(paths.size()));
+        std::vector<QString> errors(std::size_t(paths.size()));
+        parallelFor(profiles.size(), threads, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                DxDiagReport report;
+                if (loadDxDiagCapture(paths.at(qsizetype(i)), report, errors[i])) {
+                    profiles[i] = buildSystemProfile(extractSystemSpecs(report));
+                } else if (errors[i].isEmpty()) {
+                    errors[i] = QStringLiteral("Unknown error");
+                }
+            }
+        });
+
+        LoadResult result;
+        reserve(size() + int(paths.size()));
+        for (std::size_t i = 0; i < profiles.size(); ++i) {
+            if (!errors[i].isEmpty()) {
+                result.errors.append(paths.at(qsizetype(i)) + ": " + errors[i]);
+                continue;
+            }
+            addMachine(paths.at(qsizetype(i)), profiles[i]);
+            ++result.loaded;
+        }
+        build();
+        return result;
+    }
+
+    int size() const { return int(m_profiles.size()); }
+    const QString& id(int machine) const { return m_ids.at(machine); }
+    const SystemProfile& profile(int machine) const { return m_profiles[std::size_t(machine)]; }
+
+    // Indexes of the machines that meet every component, ascending.
+    std::vector<int> machinesMeeting(const RequirementProfile& requirement) const {
+        std::vector<int> machines;
+        // meetsAll() needs a positive amount on both sides of RAM and storage.
+        if (!requirement.hasCpu || !requirement.hasGpu || requirement.ramMb <= 0 || requirement.storageMb <= 0) {
+            return machines;
+        }
+
+        const Range ram = atLeast(m_ram, requirement.ramMb);
+        const Range storage = atLeast(m_storage, requirement.storageMb);
+        const Range narrowest = ram.size() <= storage.size() ? ram : storage;
+        // Without a benchmark score the GPU is judged by tier, and a machine
+        // of a lower tier cannot pass. Untiered machines fall back to VRAM,
+        // so they stay candidates.
+        if (requirement.gpuScore == 0 && requirement.gpuRank > 0) {
+            const Range tiered = atLeast(m_gpuTier, requirement.gpuRank);
+            const Range untiered = {m_gpuTier.data(), atLeast(m_gpuTier, 1).begin};
+            if (tiered.size() + untiered.size() < narrowest.size()) {
+                collect(untiered, requirement, machines);
+                collect(tiered, requirement, machines);
+                std::sort(machines.begin(), machines.end());
+                return machines;
+            }
+        }
+        collect(narrowest, requirement, machines);
+        std::sort(machines.begin(), machines.end());
+        return machines;
+    }
+
+    std::vector<int> machinesMeeting(const GameRequirements& requirements) const {
+        return machinesMeeting(buildRequirementProfile(requirements));
+    }
+
+private:
+    struct Entry {
+        qint32 value;
+        qint32 machine;
+    };
+
+    struct Range {
+        const Entry* begin;
+        const Entry* end;
+        std::size_t size() const { return std::size_t(end - begin); }
+    };
+
+    static Range atLeast(const std::vector<Entry>& entries, qint32 value) {
+        const Entry* first = entries.data();
+        const Entry* last = first + entries.size();
+        return {std::lower_bound(first, last, value, [](const Entry& entry, qint32 bound) { return entry.value < bound; }), last};
+    }
+
+    void collect(const Range& range, const RequirementProfile& requirement, std::vector<int>& machines) const {
+        for (const Entry* entry = range.begin; entry != range.end; ++entry) {
+            const SystemProfile& profile = m_profiles[std::size_t(entry->machine)];
+            if (profile.ramMb < requirement.ramMb || profile.storageMb < requirement.storageMb) continue;
+            if (compareProfiles(profile, requirement).meetsAll()) {
+                machines.push_back(entry->machine);
+            }
+        }
+    }
+
+    QStringList m_ids;
+    std::vector<SystemProfile> m_profiles;
+    std::vector<Entry> m_ram;
+    std::vector<Entry> m_gpuTier;
+    std::vector<Entry> m_storage;
+};
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringView>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+// Offline title search over a Steam app-list dump
+// (api.steampowered.com/ISteamApps/GetAppList/v2). Names are reduced to
+// case-folded, accent-free keys kept in one sorted string pool, so prefix
+// search is a binary search. A trigram inverted index (CSR layout: sorted
+// trigram table, offsets, postings) finds near misses, which are verified
+// with a prefix edit distance.
+class GameNameIndex {
+public:
+    struct Match {
+        quint32 appId = 0;
+        QString name;
+        int distance = 0;  // 0 for exact and prefix matches
+    };
+
+    static const GameNameIndex& instance() {
+        static const GameNameIndex index(defaultPath());
+        return index;
+    }
+
+    // SYSREQ_APPLIST, else steam_applist.json next to the executable, else
+    // in the working directory.
+    static QString defaultPath() {
+        QString path = qEnvironmentVariable("SYSREQ_APPLIST");
+        if (path.isEmpty() && QCoreApplication::instance()) {
+            path = QCoreApplication::applicationDirPath() + "/steam_applist.json";
+        }
+        if (path.isEmpty() || !QFile::exists(path)) {
+            path = "steam_applist.json";
+        }
+        return path;
+    }
+
+    // "The Witcher® 3: Wild Hunt" -> "the witcher 3 wild hunt"
+    static QByteArray normalizeName(QStringView name) {
+        const QString decomposed = name.toString().normalized(QString::NormalizationForm_KD);
+        QString key;
+        key.reserve(decomposed.size());
+        bool pendingSpace = false;
+        for (QChar c : decomposed) {
+            if (c.isMark()) continue;
+            if (c.isLetterOrNumber()) {
+                if (pendingSpace && !key.isEmpty()) key.append(u' ');
+                pendingSpace = false;
+                key.append(c.toCaseFolded());
+            } else if (c.isSpace() || c.isPunct() || c.isSymbol()) {
+                pendingSpace = true;
+            }
+        }
+        return key.toUtf8();
+    }
+
+    GameNameIndex() = default;
+    explicit GameNameIndex(const QString& path) { load(path); }
+
+    bool load(const QString& path) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qDebug() << "Steam app list not available:" << path;
+            return false;
+        }
+        QElapsedTimer timer;
+        timer.start();
+        if (!loadAppList(file.readAll())) {
+            qDebug() << "Invalid Steam app list:" << path;
+            return false;
+        }
+        qDebug() << "Indexed" << size() << "Steam titles from" << path << "in" << timer.elapsed() << "ms";
+        return true;
+    }
+
+    // Accepts {"applist":{"apps":[...]}}, {"response":{"apps":[...]}} or a
+    // bare array of {"appid", "name"} objects.
+    bool loadAppList(const QByteArray& json) {
+        const QJsonDocument doc = QJsonDocument::fromJson(json);
+        QJsonArray apps = doc.array();
+        if (doc.isObject()) {
+            const QJsonObject root = doc.object();
+            apps = (root.contains("applist") ? root["applist"] : root["response"]).toObject()["apps"].toArray();
+        }
+        if (apps.isEmpty()) return false;
+
+        struct Source { QByteArray key; QByteArray name; quint32 appId; };
+        std::vector<Source> sources;
+        sources.reserve(std::size_t(apps.size()));
+        for (const QJsonValue& value : apps) {
+            const QJsonObject app = value.toObject();
+            const QString name = app["name"].toString().trimmed();
+            const quint32 appId = quint32(app["appid"].toDouble());
+            QByteArray key = normalizeName(name);
+            if (appId == 0 || key.isEmpty() || key.size() > 0xFFFF) continue;
+            sources.push_back({std::move(key), name.toUtf8(), appId});
+        }
+        std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) {
+            return a.key != b.key ? a.key < b.key : a.appId < b.appId;
+        });
+
+        m_pool.clear();
+        m_entries.clear();
+        m_entries.reserve(sources.size());
+        for (const Source& source : sources) {
+            Entry entry;
+            entry.keyOffset = quint32(m_pool.size());
+            entry.keyLength = quint16(source.key.size());
+            m_pool.append(source.key.constData(), std::size_t(source.key.size()));
+            entry.nameOffset = quint32(m_pool.size());
+            entry.nameLength = quint16(std::min<qsizetype>(source.name.size(), 0xFFFF));
+            m_pool.append(source.name.constData(), entry.nameLength);
+            entry.appId = source.appId;
+            m_entries.push_back(entry);
+        }
+        buildTrigrams();
+        return true;
+    }
+
+    int size() const { return int(m_entries.size()); }
+    bool isEmpty() const { return m_entries.empty(); }
+
+    // AppID of the title whose normalized name equals `name` (the lowest
+    // AppID if several do, which is usually the base game), or 0.
+    quint32 exactAppId(QStringView name) const {
+        const QByteArray query = normalizeName(name);
+        auto it = lowerBound(std::string_view(query.constData(), std::size_t(query.size())));
+        if (it != m_entries.end() && key(*it) == std::string_view(query.constData(), std::size_t(query.size()))) {
+            return it->appId;
+        }
+        return 0;
+    }
+
+    // Exact match first, then titles starting with the query (shortest
+    // first), then titles within maxTypos edits of a prefix.
+    QList<Match> search(QStringView text, int limit = 10) const {
+        QList<Match> matches;
+        const QByteArray normalized = normalizeName(text);
+        const std::string_view query(normalized.constData(), std::size_t(normalized.size()));
+        if (query.empty() || limit <= 0) return matches;
+
+        std::vector<std::pair<int, quint32>> ranked;  // (rank, entry)
+        for (auto it = lowerBound(query); it != m_entries.end() && key(*it).substr(0, query.size()) == query; ++it) {
+            ranked.emplace_back(int(it->keyLength - query.size()), quint32(it - m_entries.begin()));
+            if (ranked.size() >= PrefixScanLimit) break;
+        }
+        std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (const auto& [rank, index] : ranked) {
+            if (matches.size() >= limit) break;
+            matches.append(toMatch(m_entries[index], 0));
+        }
+        if (matches.size() < limit) {
+            appendFuzzy(query, limit, matches);
+        }
+        return matches;
+    }
+
+private:
+    struct Entry {
+        quint32 keyOffset;
+        quint32 nameOffset;
+        quint32 appId;
+        quint16 keyLength;
+        quint16 nameLength;
+    };
+
+    static constexpr std::size_t PrefixScanLimit = 512;
+    static constexpr std::size_t FuzzyCandidateLimit = 256;
+
+    std::string_view key(const Entry& entry) const { return std::string_view(m_pool.data() + entry.keyOffset, entry.keyLength); }
+
+    std::vector<Entry>::const_iterator lowerBound(std::string_view query) const {
+        return std::lower_bound(m_entries.begin(), m_entries.end(), query,
+                                [this](const Entry& entry, std::string_view q) { return key(entry) < q; });
+    }
+
+    Match toMatch(const Entry& entry, int distance) const {
+        return {entry.appId, QString::fromUtf8(m_pool.data() + entry.nameOffset, entry.nameLength), distance};
+    }
+
+    static quint32 trigram(const char* p) {
+        return (quint32(uchar(p[0])) << 16) | (quint32(uchar(p[1])) << 8) | quint32(uchar(p[2]));
+    }
+
+    void buildTrigrams() {
+        std::vector<std::pair<quint32, quint32>> pairs;  // (trigram, entry)
+        for (quint32 i = 0; i < m_entries.size(); ++i) {
+            const std::string_view k = key(m_entries[i]);
+            const std::size_t first = pairs.size();
+            for (std::size_t j = 0; j + 3 <= k.size(); ++j) {
+                pairs.emplace_back(trigram(k.data() + j), i);
+            }
+            std::sort(pairs.begin() + std::ptrdiff_t(first), pairs.end());
+            pairs.erase(std::unique(pairs.begin() + std::ptrdiff_t(first), pairs.end()), pairs.end());
+        }
+        std::sort(pairs.begin(), pairs.end());
+
+        m_trigrams.clear();
+        m_trigramOffsets.clear();
+        m_postings.clear();
+        m_postings.reserve(pairs.size());
+        for (std::size_t i = 0; i < pairs.size(); ++i) {
+            if (i == 0 || pairs[i].first != pairs[i - 1].first) {
+                m_trigrams.push_back(pairs[i].first);
+                m_trigramOffsets.push_back(quint32(m_postings.size()));
+            }
+            m_postings.push_back(pairs[i].second);
+        }
+        m_trigramOffsets.push_back(quint32(m_postings.size()));
+    }
+
+    // Levenshtein distance between query and the closest prefix of text.
+    static int prefixDistance(std::string_view query, std::string_view text, int maxDistance) {
+        const std::size_t columns = std::min(text.size(), query.size() + std::size_t(maxDistance));
+        std::vector<int> row(columns + 1);
+        for (std::size_t j = 0; j <= columns; ++j) row[j] = int(j);
+        for (std::size_t i = 1; i <= query.size(); ++i) {
+            int diagonal = row[0];
+            row[0] = int(i);
+            int best = row[0];
+            for (std::size_t j = 1; j <= columns; ++j) {
+                const int above = row[j];
+                row[j] = std::min({above + 1, row[j - 1] + 1, diagonal + (query[i - 1] == text[j - 1] ? 0 : 1)});
+                diagonal = above;
+                best = std::min(best, row[j]);
+            }
+            if (best > maxDistance) return maxDistance + 1;
+        }
+        return *std::min_element(row.begin(), row.end());
+    }
+
+    void appendFuzzy(std::string_view query, int limit, QList<Match>& matches) const {
+        if (query.size() < 3 || m_trigrams.empty()) return;
+        const int maxTypos = query.size() <= 5 ? 1 : 2;
+
+        std::vector<quint32> grams;
+        for (std::size_t j = 0; j + 3 <= query.size(); ++j) grams.push_back(trigram(query.data() + j));
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+        thread_local std::vector<quint16> counts;
+        thread_local std::vector<quint32> touched;
+        counts.assign(m_entries.size(), 0);
+        touched.clear();
+        for (quint32 gram : grams) {
+            auto it = std::lower_bound(m_trigrams.begin(), m_trigrams.end(), gram);
+            if (it == m_trigrams.end() || *it != gram) continue;
+            const std::size_t slot = std::size_t(it - m_trigrams.begin());
+            for (quint32 p = m_trigramOffsets[slot]; p < m_trigramOffsets[slot + 1]; ++p) {
+                const quint32 entry = m_postings[p];
+                if (counts[entry]++ == 0) touched.push_back(entry);
+            }
+        }
+
+        // Each edit destroys at most three trigrams.
+        const int required = std::max(1, int(grams.size()) - 3 * maxTypos);
+        std::vector<quint32> candidates;
+        for (quint32 entry : touched) {
+            if (counts[entry] >= required) candidates.push_back(entry);
+        }
+        if (candidates.size() > FuzzyCandidateLimit) {
+            std::nth_element(candidates.begin(), candidates.begin() + FuzzyCandidateLimit, candidates.end(),
+                             [](quint32 a, quint32 b) { return counts[a] > counts[b]; });
+            candidates.resize(FuzzyCandidateLimit);
+        }
+
+        std::vector<std::pair<std::pair<int, int>, quint32>> ranked;  // ((distance, length), entry)
+        for (quint32 entry : candidates) {
+            const std::string_view k = key(m_entries[entry]);
+            if (k.substr(0, query.size()) == query) continue;  // already listed as a prefix match
+            const int distance = prefixDistance(query, k, maxTypos);
+            if (distance <= maxTypos) ranked.push_back({{distance, int(k.size())}, entry});
+        }
+        std::sort(ranked.begin(), ranked.end());
+        for (const auto& [rank, entry] : ranked) {
+            if (matches.size() >= limit) break;
+            matches.append(toMatch(m_entries[entry], rank.first));
+        }
+    }
+
+    std::string m_pool;
+    std::vector<Entry> m_entries;
+    std::vector<quint32> m_trigrams;
+    std::vector<quint32> m_trigramOffsets;
+    std::vector<quint32> m_postings;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+
+
+// A named tier above the minimum: Steam's "Recommended", or a store's own
+// presets ("High", "Ultra", "VR"). Empty fields inherit from the tier below.
+struct RequirementTier {
+    QString name;
+    QString cpu;
+    QString gpu;
+    QString ram;
+    QString storage;
+};
+
+// The minimum tier, plus any higher tiers in ascending order.
+struct GameRequirements {
+    QString cpu;
+    QString gpu;
+    QString ram;
+    QString storage;
+    QList<RequirementTier> tiers;
+};
+
+inline QString requirementTierName(const GameRequirements& requirements, int tier) {
+    if (tier == 0) return QStringLiteral("Minimum");
+    return tier > 0 && tier <= requirements.tiers.size() ? requirements.tiers.at(tier - 1).name : QString();
+}
@@ -8,19 +8,18 @@
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QRegularExpression>
-
-
-struct GameRequirements {
-    QString cpu;
-    QString gpu;
-    QString ram;
-    QString storage;
-    
-};
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTimer>
+#include <functional>
+#include <memory>
+#include <optional>
+#include "GameNameIndex.h"
+#include "GameRequirements.h"
+#include "NetworkAccess.h"
+#include "RequirementsCache.h"
+#include "RequirementsSources.h"
+#include "Trace.h"
 
 class GameRequirementsWorker : public QObject
 {
@@ -34,242 +33,226 @@ public:
 public slots:
     void processRequirementsSearch()
     {
+        if (m_done) {
+            return;
+        }
         emit started();
         qDebug() << "GameRequirementsWorker::processRequirementsSearch started for:" << m_gameName;
+        m_elapsed.start();
 
         if (!m_appId.isEmpty()) {
-            
-            QString steamUrl = QString("https://store.steampowered.com/api/appdetails?appids=%1&l=english").arg(m_appId);
-            QNetworkAccessManager* steamManager = new QNetworkAccessManager(this);
-            QNetworkRequest steamRequest{QUrl(steamUrl)};
-            QObject::connect(steamManager, &QNetworkAccessManager::finished, this, [=](QNetworkReply* steamReply) {
-                if (steamReply->error() == QNetworkReply::NoError) {
-                    QByteArray steamResponse = steamReply->readAll();
-                    QJsonDocument steamDoc = QJsonDocument::fromJson(steamResponse);
-                    QJsonObject root = steamDoc.object();
-                    QJsonObject appObj = root[m_appId].toObject();
-                    if (appObj["success"].toBool()) {
-                        QJsonObject data = appObj["data"].toObject();
-                        QString gameName = data["name"].toString();
-                        emit gameNameFound(gameName);
-                        QJsonObject pcReqs = data["pc_requirements"].toObject();
-                        QString minReq = pcReqs["minimum"].toString();
-                        QString recReq = pcReqs["recommended"].toString();
-                        qDebug() << "Steam minimum requirements (HTML):" << minReq;
-                        qDebug() << "Steam recommended requirements (HTML):" << recReq;
-                        if (!minReq.isEmpty()) {
-                            
-                            minReq.replace("Processor:", "\nProcessor:");
-                            minReq.replace("Memory:", "\nMemory:");
-                            minReq.replace("Graphics:", "\nGraphics:");
-                            minReq.replace("DirectX:", "\nDirectX:");
-                            minReq.replace("Storage:", "\nStorage:");
-                            minReq.replace("Additional Notes:", "\nAdditional Notes:");
-                            
-                            GameRequirements requirements;
-                            QRegularExpression cpuRe("Processor:([^\n]*)");
-                            QRegularExpression ramRe("Memory:([^\n]*)");
-                            QRegularExpression gpuRe("Graphics:([^\n]*)");
-                            QRegularExpression storageRe("Storage:([^\n]*)");
-                            QRegularExpressionMatch match;
-                            match = cpuRe.match(minReq);
-                            requirements.cpu = match.hasMatch() ? match.captured(1).trimmed() : "";
-                            requirements.cpu.remove(QRegularExpression("<[^>]*>"));
-                            match = ramRe.match(minReq);
-                            requirements.ram = match.hasMatch() ? match.captured(1).trimmed() : "";
-                            requirements.ram.remove(QRegularExpression("<[^>]*>"));
-                            match = gpuRe.match(minReq);
-                            requirements.gpu = match.hasMatch() ? match.captured(1).trimmed() : "";
-                            requirements.gpu.remove(QRegularExpression("<[^>]*>"));
-                            match = storageRe.match(minReq);
-                            requirements.storage = match.hasMatch() ? match.captured(1).trimmed() : "";
-                            requirements.storage.remove(QRegularExpression("<[^>]*>"));
-                            
-                            if (requirements.cpu.isEmpty() && requirements.gpu.isEmpty() && requirements.ram.isEmpty() && requirements.storage.isEmpty()) {
-                                requirements.cpu = minReq;
-                            }
-                            emit searchFinished(requirements);
-                            qDebug() << "Emitted searchFinished with Steam minimum requirements (AppID):" << requirements.cpu << requirements.gpu << requirements.ram << requirements.storage;
-                            emit finished();
-                            steamReply->deleteLater();
-                            steamManager->deleteLater();
-                            return;
-                        }
-                    }
-                }
-                
-                qDebug() << "No requirements found in Steam Storefront API (AppID).";
-                GameRequirements requirements;
-                requirements.cpu = "No requirements found.";
-                requirements.gpu = "";
-                requirements.ram = "";
-                requirements.storage = "";
-                emit searchFinished(requirements);
-                emit finished();
-                steamReply->deleteLater();
-                steamManager->deleteLater();
-            });
-            steamManager->get(steamRequest);
+            m_steamAppId = m_appId;
+            startSteam();
             return;
         }
 
-        QNetworkAccessManager* manager = new QNetworkAccessManager(this);
-        QString apiKey = "df715f73748447f587032a7708b403b2";
-        QString url = QString("https://api.rawg.io/api/games?key=%1&search=%2")
-                        .arg(apiKey)
-                        .arg(QUrl::toPercentEncoding(m_gameName));
-        QNetworkRequest request{QUrl(url)};
+        // A title in the local app list goes straight to Steam, so a cached
+        // title needs no network at all.
+        if (const quint32 indexedAppId = GameNameIndex::instance().exactAppId(m_gameName)) {
+            qDebug() << "Resolved" << m_gameName << "to AppID" << indexedAppId << "from the local index";
+            m_steamAppId = QString::number(indexedAppId);
+            startSteam();
+            return;
+        }
 
-        QObject::connect(manager, &QNetworkAccessManager::finished, this, [=](QNetworkReply* reply) {
-            bool foundRAWG = false;
-            if (reply->error() == QNetworkReply::NoError) {
-                QByteArray response = reply->readAll();
-                QJsonDocument doc = QJsonDocument::fromJson(response);
-                QJsonObject obj = doc.object();
-                QJsonArray results = obj["results"].toArray();
-                for (const QJsonValue& value : results) {
-                    QJsonObject game = value.toObject();
-                    qDebug() << "RAWG Game:" << game["name"].toString();
-                    
-                    QJsonArray platforms = game["platforms"].toArray();
-                    for (const QJsonValue& platVal : platforms) {
-                        QJsonObject platObj = platVal.toObject();
-                        QJsonObject platform = platObj["platform"].toObject();
-                        qDebug() << "Platform JSON:" << QJsonDocument(platObj).toJson(QJsonDocument::Compact);
-                        if (platform["name"].toString().toLower() == "pc") {
-                            QJsonObject reqs = platObj["requirements"].toObject();
-                            qDebug() << "PC requirements JSON:" << QJsonDocument(reqs).toJson(QJsonDocument::Compact);
-                            QString minReq = reqs["minimum"].toString();
-                            QString recReq = reqs["recommended"].toString();
-                            if (!minReq.isEmpty()) {
-                                GameRequirements requirements;
-                                requirements.cpu = minReq; 
-                                requirements.gpu = "";
-                                requirements.ram = "";
-                                requirements.storage = "";
-                                emit searchFinished(requirements);
-                                qDebug() << "Emitted searchFinished with minimum requirements:" << minReq;
-                                emit finished();
-                                reply->deleteLater();
-                                manager->deleteLater();
-                                return;
-                            }
-                        }
-                    }
-                }
-            }
-            
-            qDebug() << "No PC requirements found in RAWG response. Trying Steam Storefront API...";
-            
-            
-            QMap<QString, QString> appIdMap = {
-                {"cyberpunk 2077", "1091500"},
-                {"half-life 2", "220"},
-                {"elden ring", "1245620"}
-            };
-            QString key = m_gameName.trimmed().toLower();
-            QString appid = appIdMap.value(key, "");
-            if (!appid.isEmpty()) {
-                QString steamUrl = QString("https://store.steampowered.com/api/appdetails?appids=%1&l=english").arg(appid);
-                QNetworkAccessManager* steamManager = new QNetworkAccessManager(this);
-                QNetworkRequest steamRequest{QUrl(steamUrl)};
-                QObject::connect(steamManager, &QNetworkAccessManager::finished, this, [=](QNetworkReply* steamReply) {
-                    if (steamReply->error() == QNetworkReply::NoError) {
-                        QByteArray steamResponse = steamReply->readAll();
-                        QJsonDocument steamDoc = QJsonDocument::fromJson(steamResponse);
-                        QJsonObject root = steamDoc.object();
-                        QJsonObject appObj = root[appid].toObject();
-                        if (appObj["success"].toBool()) {
-                            QJsonObject data = appObj["data"].toObject();
-                            QString gameName = data["name"].toString();
-                            emit gameNameFound(gameName);
-                            QJsonObject pcReqs = data["pc_requirements"].toObject();
-                            QString minReq = pcReqs["minimum"].toString();
-                            QString recReq = pcReqs["recommended"].toString();
-                            qDebug() << "Steam minimum requirements (HTML):" << minReq;
-                            qDebug() << "Steam recommended requirements (HTML):" << recReq;
-                            if (!minReq.isEmpty()) {
-                                
-                                minReq.replace("Processor:", "\nProcessor:");
-                                minReq.replace("Memory:", "\nMemory:");
-                                minReq.replace("Graphics:", "\nGraphics:");
-                                minReq.replace("DirectX:", "\nDirectX:");
-                                minReq.replace("Storage:", "\nStorage:");
-                                minReq.replace("Additional Notes:", "\nAdditional Notes:");
-                                
-                                GameRequirements requirements;
-                                QRegularExpression cpuRe("Processor:([^\n]*)");
-                                QRegularExpression ramRe("Memory:([^\n]*)");
-                                QRegularExpression gpuRe("Graphics:([^\n]*)");
-                                QRegularExpression storageRe("Storage:([^\n]*)");
-                                QRegularExpressionMatch match;
-                                match = cpuRe.match(minReq);
-                                requirements.cpu = match.hasMatch() ? match.captured(1).trimmed() : "";
-                                requirements.cpu.remove(QRegularExpression("<[^>]*>"));
-                                match = ramRe.match(minReq);
-                                requirements.ram = match.hasMatch() ? match.captured(1).trimmed() : "";
-                                requirements.ram.remove(QRegularExpression("<[^>]*>"));
-                                match = gpuRe.match(minReq);
-                                requirements.gpu = match.hasMatch() ? match.captured(1).trimmed() : "";
-                                requirements.gpu.remove(QRegularExpression("<[^>]*>"));
-                                match = storageRe.match(minReq);
-                                requirements.storage = match.hasMatch() ? match.captured(1).trimmed() : "";
-                                requirements.storage.remove(QRegularExpression("<[^>]*>"));
-                                
-                                if (requirements.cpu.isEmpty() && requirements.gpu.isEmpty() && requirements.ram.isEmpty() && requirements.storage.isEmpty()) {
-                                    requirements.cpu = minReq;
-                                }
-                                emit searchFinished(requirements);
-                                qDebug() << "Emitted searchFinished with Steam minimum requirements:" << requirements.cpu << requirements.gpu << requirements.ram << requirements.storage;
-                                emit finished();
-                                steamReply->deleteLater();
-                                steamManager->deleteLater();
-                                reply->deleteLater();
-                                manager->deleteLater();
-                                return;
-                            }
-                        }
-                    }
-                    
-                    qDebug() << "No requirements found in Steam Storefront API.";
-                    GameRequirements requirements;
-                    requirements.cpu = "No requirements found.";
-                    requirements.gpu = "";
-                    requirements.ram = "";
-                    requirements.storage = "";
-                    emit searchFinished(requirements);
-                    emit finished();
-                    steamReply->deleteLater();
-                    steamManager->deleteLater();
-                    reply->deleteLater();
-                    manager->deleteLater();
-                });
-                steamManager->get(steamRequest);
-                return;
-            }
-            
-            GameRequirements requirements;
-            requirements.cpu = "No requirements found.";
-            requirements.gpu = "";
-            requirements.ram = "";
-            requirements.storage = "";
-            emit searchFinished(requirements);
-            emit finished();
-            reply->deleteLater();
-            manager->deleteLater();
-        });
+        m_steamAppId = steamAppIdForName(m_gameName);
+        startRawg();
+        if (m_done || m_steamAppId.isEmpty() || m_steamState != SourceState::Idle) {
+            return;
+        }
+        if (m_timings.hedgeDelayMs == 0) {
+            startSteam();
+            return;
+        }
+        m_hedgeTimer = new QTimer(this);
+        m_hedgeTimer->setSingleShot(true);
+        connect(m_hedgeTimer, &QTimer::timeout, this, &GameRequirementsWorker::startSteam);
+        m_hedgeTimer->start(m_timings.hedgeDelayMs);
+    }
 
-        manager->get(request);
+    // Gives up on the search: pending requests are aborted and only
+    // finished() is emitted.
+    void cancel()
+    {
+        if (m_done) {
+            return;
+        }
+        qDebug() << "Requirements search cancelled for:" << m_gameName;
+        abortPending();
+        emit finished();
     }
 
+    void setTimings(const LookupTimings &timings) { m_timings = timings; }
+
 signals:
     void started();
     void finished();
     void error(const QString &message);
     void searchFinished(const GameRequirements &requirements);
     void gameNameFound(const QString &name);
+    void lookupResolved(const QString &source, qint64 elapsedMs);
 
 private:
+    enum class SourceState { Idle, Pending, Done };
+
+    // Answers from the cache when the entry is fresh (returning nullptr);
+    // otherwise sends the request, revalidating a stale entry, and falls back
+    // to it if the source is unreachable or the body does not parse. The body is decoded as it arrives,
+    // keeping only `paths`, and `parse` sees that extract. Replies that
+    // finish after the search is resolved, including aborted ones, are
+    // ignored.
+    QNetworkReply* fetchCached(const QString &key, const QUrl &url, int timeoutMs, const std::vector<std::string> &paths,
+                               std::function<bool(const QByteArray &, CachedRequirements &)> parse,
+                               std::function<void(const CachedRequirements &)> done)
+    {
+        const std::optional<CachedRequirements> cached = RequirementsCache::instance().lookup(key);
+        if (cached && RequirementsCache::instance().isFresh(*cached)) {
+            qDebug() << "Requirements cache hit:" << key;
+            done(*cached);
+            return nullptr;
+        }
+
+        QNetworkRequest request(url);
+        request.setTransferTimeout(timeoutMs);
+        if (cached) {
+            RequirementsCache::addValidators(request, *cached);
+        }
+        const Trace::Timestamp sent = Trace::now();
+        QNetworkReply* reply = sharedNetworkAccessManager()->get(request);
+        auto extractor = std::make_shared<JsonPathExtractor>(paths);
+        connect(reply, &QNetworkReply::readyRead, this, [reply, extractor]() {
+            extractor->feed(reply->readAll());
+        });
+        connect(reply, &QNetworkReply::finished, this, [=]() {
+            reply->deleteLater();
+            Trace::complete("http fetch", sent);
+            if (m_done) {
+                return;
+            }
+            if (cached && RequirementsCache::isNotModified(reply)) {
+                qDebug() << "Requirements not modified:" << key;
+                RequirementsCache::instance().store(key, *cached);
+                done(*cached);
+                return;
+            }
+            if (reply->error() == QNetworkReply::NoError) {
+                extractor->feed(reply->readAll());
+                if (extractor->isComplete()) {
+                    CachedRequirements entry;
+                    entry.payload = extractor->toJson();
+                    entry.found = parse(entry.payload, entry);
+                    RequirementsCache::instance().storeReply(key, reply, entry.payload, entry.requirements, entry.gameName, entry.found);
+                    done(entry);
+                    return;
+                }
+                // A cut-off body or an error page: not an answer, so not cached.
+                qDebug() << "Malformed or truncated response:" << key;
+            } else {
+                qDebug() << "Request failed:" << key << reply->errorString();
+            }
+            done(cached ? *cached : CachedRequirements());
+        });
+        return reply;
+    }
+
+    void startRawg()
+    {
+        m_rawgState = SourceState::Pending;
+        m_rawgReply = fetchCached(RequirementsCache::rawgKey(m_gameName), rawgSearchUrl(m_gameName), m_timings.rawgTimeoutMs, rawgSearchPaths(),
+            [](const QByteArray &payload, CachedRequirements &entry) {
+                return parseRawgSearch(payload, entry.requirements);
+            },
+            [this](const CachedRequirements &entry) { onRawgResult(entry); });
+    }
+
+    void startSteam()
+    {
+        if (m_done || m_steamState != SourceState::Idle) {
+            return;
+        }
+        if (m_hedgeTimer) {
+            m_hedgeTimer->stop();
+        }
+        const QString appId = m_steamAppId;
+        m_steamState = SourceState::Pending;
+        m_steamReply = fetchCached(RequirementsCache::steamKey(appId), steamAppDetailsUrl(appId), m_timings.steamTimeoutMs, steamAppDetailsPaths(),
+            [appId](const QByteArray &payload, CachedRequirements &entry) {
+                if (parseSteamAppDetails(payload, appId, entry.requirements, entry.gameName)) {
+                    return true;
+                }
+                qDebug() << "No requirements found in Steam Storefront API for AppID" << appId;
+                entry.requirements = notFoundRequirements();
+                return false;
+            },
+            [this](const CachedRequirements &entry) { onSteamResult(entry); });
+    }
+
+    void onRawgResult(const CachedRequirements &entry)
+    {
+        m_rawgState = SourceState::Done;
+        m_rawgReply = nullptr;
+        if (entry.found) {
+            resolve("RAWG", entry.requirements);
+            return;
+        }
+        qDebug() << "No PC requirements found in RAWG response.";
+        if (!m_steamAppId.isEmpty() && m_steamState == SourceState::Idle) {
+            startSteam();  // no point waiting out the hedge delay
+        } else if (m_steamState != SourceState::Pending) {
+            resolve(QString(), notFoundRequirements());
+        }
+    }
+
+    void onSteamResult(const CachedRequirements &entry)
+    {
+        m_steamState = SourceState::Done;
+        m_steamReply = nullptr;
+        if (!entry.gameName.isEmpty()) {
+            emit gameNameFound(entry.gameName);
+        }
+        if (entry.found) {
+            resolve("Steam", entry.requirements);
+        } else if (m_rawgState == SourceState::Idle && !m_gameName.isEmpty()) {
+            startRawg();
+        } else if (m_rawgState != SourceState::Pending) {
+            resolve(QString(), notFoundRequirements());
+        }
+    }
+
+    void abortPending()
+    {
+        m_done = true;
+        if (m_hedgeTimer) {
+            m_hedgeTimer->stop();
+        }
+        if (m_rawgReply) {
+            m_rawgReply->abort();
+        }
+        if (m_steamReply) {
+            m_steamReply->abort();
+        }
+    }
+
+    void resolve(const QString &source, const GameRequirements &requirements)
+    {
+        abortPending();
+        const qint64 elapsedMs = m_elapsed.elapsed();
+        qDebug() << "Requirements resolved by" << (source.isEmpty() ? QStringLiteral("no source") : source) << "in" << elapsedMs << "ms";
+        emit lookupResolved(source, elapsedMs);
+        emit searchFinished(requirements);
+        qDebug() << "Emitted searchFinished with:" << requirements.cpu << requirements.gpu << requirements.ram << requirements.storage;
+        emit finished();
+    }
+
     QString m_gameName;
     QString m_appId;
-}; 
\ No newline at end of file
+    QString m_steamAppId;
+    LookupTimings m_timings = LookupTimings::fromEnvironment();
+    QTimer* m_hedgeTimer = nullptr;
+    QPointer<QNetworkReply> m_rawgReply;
+    QPointer<QNetworkReply> m_steamReply;
+    SourceState m_rawgState = SourceState::Idle;
+    SourceState m_steamState = SourceState::Idle;
+    bool m_done = false;
+    QElapsedTimer m_elapsed;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <tuple>
+#include "DxDiagReport.h"
+#include "HardwareDatabase.h"
+#include "HardwareMatcher.h"
+
+
+// One display adapter from the DisplayDevices section. Hybrid laptops list
+// the integrated GPU and the discrete one, in no particular order, so the
+// comparison has to pick rather than take the last CardName.
+struct GpuAdapter {
+    enum class Role {
+        Unknown,
+        Integrated,
+        Discrete
+    };
+
+    QString name;
+    QString manufacturer;
+    quint32 vendorId = 0;
+    quint32 deviceId = 0;
+    int dedicatedMb = 0;
+    int sharedMb = 0;
+    int maxFeatureLevel = 0;  // "12_2" -> 122
+    QString featureLevels;
+    QString driverModel;
+    QString driverVersion;
+    Role role = Role::Unknown;
+
+    // Filled by rankGpuAdapters().
+    quint32 score = 0;
+    int rank = 0;
+
+    // dxdiag only labels adapters on hybrid systems; otherwise a card with
+    // its own memory is taken to be discrete. The Microsoft Basic Render
+    // Driver never is.
+    bool isDiscrete() const {
+        if (vendorId == 0x1414) return false;
+        if (role != Role::Unknown) return role == Role::Discrete;
+        return dedicatedMb >= 1024;
+    }
+};
+
+inline int gpuMegabytes(QStringView value) {
+    const qsizetype space = value.indexOf(u' ');
+    return int((space >= 0 ? value.first(space) : value).toDouble());
+}
+
+// Splits the DisplayDevices items ({element, value} pairs, one run of
+// schema fields per adapter) into adapters. A new adapter starts at each
+// CardName or when a field repeats. Keys and values are read in place.
+inline QList<GpuAdapter> parseGpuAdapters(const DxDiagReport& report, int displayDevices) {
+    QList<GpuAdapter> adapters;
+    QList<QStringView> seen;
+    for (int i = 0; i < report.itemCount(displayDevices); ++i) {
+        if (!report.hasKey(displayDevices, i) || report.valueCount(displayDevices, i) < 1) continue;
+        const QStringView field = report.key(displayDevices, i);
+        const QStringView value = report.value(displayDevices, i, report.valueCount(displayDevices, i) - 1);
+        if (adapters.isEmpty() || field == u"CardName" || seen.contains(field)) {
+            adapters.append(GpuAdapter());
+            seen.clear();
+        }
+        seen.append(field);
+        GpuAdapter& adapter = adapters.last();
+        if (field == u"CardName") {
+            adapter.name = value.toString();
+        } else if (field == u"Manufacturer") {
+            adapter.manufacturer = value.toString();
+        } else if (field == u"VendorID") {
+            adapter.vendorId = value.toUInt(nullptr, 0);
+        } else if (field == u"DeviceID") {
+            adapter.deviceId = value.toUInt(nullptr, 0);
+        } else if (field == u"DedicatedMemory") {
+            adapter.dedicatedMb = gpuMegabytes(value);
+        } else if (field == u"SharedMemory") {
+            adapter.sharedMb = gpuMegabytes(value);
+        } else if (field == u"FeatureLevels") {
+            adapter.featureLevels = value.toString();
+            const qsizetype comma = value.indexOf(u',');
+            const QStringView highest = comma >= 0 ? value.first(comma) : value;
+            const qsizetype underscore = highest.indexOf(u'_');
+            if (underscore >= 0) adapter.maxFeatureLevel = highest.first(underscore).toInt() * 10 + highest.sliced(underscore + 1).toInt();
+        } else if (field == u"DriverModel") {
+            adapter.driverModel = value.toString();
+        } else if (field == u"DriverVersion") {
+            adapter.driverVersion = value.toString();
+        } else if (field == u"HybridGraphicsGPUType") {
+            adapter.role = value.contains(u"Discrete", Qt::CaseInsensitive) ? GpuAdapter::Role::Discrete
+                         : value.contains(u"Integrated", Qt::CaseInsensitive) ? GpuAdapter::Role::Integrated
+                         : GpuAdapter::Role::Unknown;
+        }
+    }
+    return adapters;
+}
+
+// Scores every adapter and returns the index of the one to compare with:
+// discrete before integrated, then benchmark score, tier, VRAM and
+// Direct3D feature level. -1 if there are none.
+inline int rankGpuAdapters(QList<GpuAdapter>& adapters) {
+    int best = -1;
+    auto key = [](const GpuAdapter& adapter) {
+        return std::make_tuple(adapter.isDiscrete(), adapter.score, adapter.rank, adapter.dedicatedMb, adapter.maxFeatureLevel);
+    };
+    for (int i = 0; i < adapters.size(); ++i) {
+        GpuAdapter& adapter = adapters[i];
+        adapter.score = HardwareDatabase::instance().score(HwdbKind::Gpu, adapter.name, HardwareDatabase::Policy::Best);
+        adapter.rank = HardwareRankMatcher::instance().gpuRank(adapter.name);
+        if (!adapter.name.isEmpty() && (best < 0 || key(adapter) > key(adapters.at(best)))) {
+            best = i;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QString>
+#include <QStringView>
+#include <algorithm>
+#include <cstring>
+#include "HardwareDatabaseFormat.h"
+
+
+// Read-only view of hardware.db (see hwdb_compile.cpp). The file is mapped,
+// not parsed: lookups binary-search the fixed-width record array and
+// compare keys in place in the string pool, and processes that map the
+// same file share its pages.
+class HardwareDatabase {
+public:
+    enum class Policy {
+        Best,   // a system string: the strongest alternative found
+        Lowest  // a requirement: any listed alternative is enough
+    };
+
+    static const HardwareDatabase& instance() {
+        static const HardwareDatabase database(defaultPath());
+        return database;
+    }
+
+    // SYSREQ_HWDB, else hardware.db next to the executable, else in the
+    // working directory.
+    static QString defaultPath() {
+        QString path = qEnvironmentVariable("SYSREQ_HWDB");
+        if (path.isEmpty() && QCoreApplication::instance()) {
+            path = QCoreApplication::applicationDirPath() + "/hardware.db";
+        }
+        if (path.isEmpty() || !QFile::exists(path)) {
+            path = "hardware.db";
+        }
+        return path;
+    }
+
+    HardwareDatabase() = default;
+    explicit HardwareDatabase(const QString& path) { open(path); }
+    HardwareDatabase(const HardwareDatabase&) = delete;
+    HardwareDatabase& operator=(const HardwareDatabase&) = delete;
+    ~HardwareDatabase() { close(); }
+
+    bool open(const QString& path) {
+        close();
+        m_file.setFileName(path);
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            qDebug() << "Hardware database not available:" << path;
+            return false;
+        }
+        const qint64 size = m_file.size();
+        if (size < qint64(sizeof(HwdbHeader))) {
+            qDebug() << "Hardware database too small:" << path;
+            close();
+            return false;
+        }
+        m_data = m_file.map(0, size);
+        if (!m_data) {
+            qDebug() << "Could not map hardware database:" << path;
+            close();
+            return false;
+        }
+
+        const HwdbHeader* header = reinterpret_cast<const HwdbHeader*>(m_data);
+        const quint64 recordsEnd = quint64(header->recordsOffset) + quint64(header->recordCount) * sizeof(HwdbRecord);
+        const quint64 poolEnd = quint64(header->stringPoolOffset) + header->stringPoolSize;
+        if (std::memcmp(header->magic, HwdbMagic, sizeof(HwdbMagic)) != 0 || header->version != HwdbVersion
+            || recordsEnd > quint64(size) || poolEnd > quint64(size) || header->recordsOffset % alignof(HwdbRecord) != 0) {
+            qDebug() << "Invalid hardware database:" << path;
+            close();
+            return false;
+        }
+        m_records = reinterpret_cast<const HwdbRecord*>(m_data + header->recordsOffset);
+        m_recordCount = header->recordCount;
+        m_pool = reinterpret_cast<const char*>(m_data + header->stringPoolOffset);
+        m_poolSize = header->stringPoolSize;
+        for (quint32 i = 0; i < m_recordCount; ++i) {
+            const HwdbRecord& record = m_records[i];
+            if (quint64(record.keyOffset) + record.keyLength > m_poolSize || quint64(record.nameOffset) + record.nameLength > m_poolSize) {
+                qDebug() << "Invalid string reference in hardware database:" << path;
+                close();
+                return false;
+            }
+        }
+        qDebug() << "Hardware database mapped:" << path << "with" << m_recordCount << "records";
+        return true;
+    }
+
+    void close() {
+        if (m_data) {
+            m_file.unmap(m_data);
+        }
+        m_file.close();
+        m_data = nullptr;
+        m_records = nullptr;
+        m_recordCount = 0;
+        m_pool = nullptr;
+        m_poolSize = 0;
+    }
+
+    bool isOpen() const { return m_records != nullptr; }
+    quint32 size() const { return m_recordCount; }
+
+    // Looks up one model name. If the full key is unknown, trailing tokens
+    // are dropped ("rtx 3060 6gb" -> "rtx 3060") until a key matches.
+    const HwdbRecord* find(HwdbKind kind, QStringView model) const {
+        if (!isOpen()) return nullptr;
+        char key[HwdbMaxKeyLength];
+        std::size_t length = hwdbNormalize(model.utf16(), std::size_t(model.size()), key);
+        while (length > 0) {
+            if (const HwdbRecord* record = findKey(kind, key, length)) {
+                return record;
+            }
+            while (length > 0 && key[length - 1] != ' ') --length;
+            if (length > 0) --length;
+        }
+        return nullptr;
+    }
+
+    // Score for a free-text CPU/GPU field that may list alternatives
+    // ("GTX 970 / RX 470"). Returns 0 when nothing is found.
+    quint32 score(HwdbKind kind, QStringView text, Policy policy) const {
+        if (!isOpen()) return 0;
+        quint32 result = 0;
+        hwdbForEachAlternative(text.utf16(), std::size_t(text.size()), [&](const char16_t* begin, std::size_t length) {
+            const HwdbRecord* record = find(kind, QStringView(begin, qsizetype(length)));
+            if (!record || record->score == 0) return;
+            if (result == 0) result = record->score;
+            else result = policy == Policy::Best ? std::max(result, record->score) : std::min(result, record->score);
+        });
+        return result;
+    }
+
+    QString name(const HwdbRecord& record) const {
+        return QString::fromUtf8(m_pool + record.nameOffset, record.nameLength);
+    }
+
+private:
+    const HwdbRecord* findKey(HwdbKind kind, const char* key, std::size_t length) const {
+        const HwdbRecord* end = m_records + m_recordCount;
+        const HwdbRecord* it = std::lower_bound(m_records, end, 0, [&](const HwdbRecord& record, int) {
+            if (record.kind != quint8(kind)) return record.kind < quint8(kind);
+            return compareKey(record, key, length) < 0;
+        });
+        if (it != end && it->kind == quint8(kind) && compareKey(*it, key, length) == 0) {
+            return it;
+        }
+        return nullptr;
+    }
+
+    int compareKey(const HwdbRecord& record, const char* key, std::size_t length) const {
+        std::size_t common = std::min<std::size_t>(record.keyLength, length);
+        int cmp = std::memcmp(m_pool + record.keyOffset, key, common);
+        if (cmp != 0) return cmp;
+        return record.keyLength < length ? -1 : (record.keyLength > length ? 1 : 0);
+    }
+
+    QFile m_file;
+    uchar* m_data = nullptr;
+    const HwdbRecord* m_records = nullptr;
+    quint32 m_recordCount = 0;
+    const char* m_pool = nullptr;
+    quint32 m_poolSize = 0;
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+// On-disk layout of hardware.db, shared by hwdb_compile and the runtime
+// reader. All integers are little-endian. The file is a header, a
+// contiguous array of fixed-width records sorted by (kind, key), then a
+// string pool holding the normalized keys and display names.
+
+constexpr char HwdbMagic[8] = {'S', 'Y', 'S', 'R', 'Q', 'D', 'B', '1'};
+constexpr uint32_t HwdbVersion = 1;
+
+enum class HwdbKind : uint8_t {
+    Cpu = 1,
+    Gpu = 2
+};
+
+enum class HwdbVendor : uint8_t {
+    Unknown = 0,
+    Intel = 1,
+    Amd = 2,
+    Nvidia = 3
+};
+
+struct HwdbHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordCount;
+    uint32_t recordsOffset;
+    uint32_t stringPoolOffset;
+    uint32_t stringPoolSize;
+    uint32_t reserved;
+};
+static_assert(sizeof(HwdbHeader) == 32, "HwdbHeader layout changed");
+
+struct HwdbRecord {
+    uint32_t keyOffset;
+    uint32_t nameOffset;
+    uint16_t keyLength;
+    uint16_t nameLength;
+    uint8_t kind;
+    uint8_t vendor;
+    uint16_t reserved;
+    uint32_t score;
+    uint32_t vramMb;
+};
+static_assert(sizeof(HwdbRecord) == 24, "HwdbRecord layout changed");
+
+
+constexpr std::size_t HwdbMaxKeyLength = 96;
+
+inline bool hwdbIsStopWord(const char* token, std::size_t length) {
+    static const char* const stopWords[] = {
+        "nvidia", "geforce", "amd", "ati", "radeon", "intel", "graphics", "gpu",
+        "laptop", "mobile", "notebook", "processor", "cpu", "core", "gen",
+        "series", "family", "video", "card", "with"
+    };
+    for (const char* word : stopWords) {
+        if (std::strlen(word) == length && std::memcmp(word, token, length) == 0) return true;
+    }
+    // Ordinals such as "12th" in "12th Gen Intel(R) Core(TM)".
+    if (length >= 3 && token[0] >= '0' && token[0] <= '9') {
+        const char* suffix = token + length - 2;
+        bool digits = true;
+        for (std::size_t i = 0; i + 2 < length; ++i) {
+            if (token[i] < '0' || token[i] > '9') digits = false;
+        }
+        if (digits && (std::memcmp(suffix, "th", 2) == 0 || std::memcmp(suffix, "st", 2) == 0
+                       || std::memcmp(suffix, "nd", 2) == 0 || std::memcmp(suffix, "rd", 2) == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reduces a marketing name to its lookup key, e.g.
+// "12th Gen Intel(R) Core(TM) i5-12450HX (12 CPUs), ~2.4GHz" -> "i5 12450hx"
+// and "NVIDIA GeForce RTX 3060 Laptop GPU" -> "rtx 3060". Works on any code
+// unit type; anything outside ASCII separates tokens. Writes at most
+// HwdbMaxKeyLength bytes to out and returns the key length.
+template <typename CharT>
+std::size_t hwdbNormalize(const CharT* text, std::size_t length, char* out) {
+    std::size_t written = 0;
+    char token[HwdbMaxKeyLength];
+    std::size_t tokenLength = 0;
+
+    auto flush = [&]() {
+        if (tokenLength > 0 && !hwdbIsStopWord(token, tokenLength)) {
+            std::size_t needed = tokenLength + (written > 0 ? 1 : 0);
+            if (written + needed <= HwdbMaxKeyLength) {
+                if (written > 0) out[written++] = ' ';
+                std::memcpy(out + written, token, tokenLength);
+                written += tokenLength;
+            }
+        }
+        tokenLength = 0;
+    };
+    auto lower = [](CharT c) -> unsigned {
+        unsigned u = static_cast<unsigned>(c);
+        return (u >= 'A' && u <= 'Z') ? u + ('a' - 'A') : u;
+    };
+
+    for (std::size_t i = 0; i < length; ++i) {
+        unsigned c = lower(text[i]);
+        if (c == '(') {
+            // Drop (R), (TM) and (C); anything else in parentheses is the
+            // start of trailing detail such as "(12 CPUs)".
+            std::size_t close = i + 1;
+            while (close < length && static_cast<unsigned>(text[close]) != ')' && close - i <= 3) ++close;
+            if (close < length && static_cast<unsigned>(text[close]) == ')') {
+                std::size_t innerLength = close - i - 1;
+                unsigned a = innerLength > 0 ? lower(text[i + 1]) : 0;
+                unsigned b = innerLength > 1 ? lower(text[i + 2]) : 0;
+                if ((innerLength == 1 && (a == 'r' || a == 'c')) || (innerLength == 2 && a == 't' && b == 'm')) {
+                    flush();
+                    i = close;
+                    continue;
+                }
+            }
+            break;
+        }
+        if (c == '@' || c == '~') break;
+        bool alnum = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+        if (alnum) {
+            if (tokenLength < HwdbMaxKeyLength) token[tokenLength++] = static_cast<char>(c);
+        } else {
+            flush();
+        }
+    }
+    flush();
+    return written;
+}
+
+// Calls fn(begin, length) for each alternative in a requirement string such
+// as "Intel Core i5-4460 / AMD FX-6300" or "GTX 970 or RX 470".
+template <typename CharT, typename Fn>
+void hwdbForEachAlternative(const CharT* text, std::size_t length, Fn&& fn) {
+    auto lower = [](CharT c) -> unsigned {
+        unsigned u = static_cast<unsigned>(c);
+        return (u >= 'A' && u <= 'Z') ? u + ('a' - 'A') : u;
+    };
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < length; ++i) {
+        unsigned c = static_cast<unsigned>(text[i]);
+        std::size_t skip = 0;
+        if (c == '/' || c == ',' || c == '|' || c == ';') {
+            skip = 1;
+        } else if (c == ' ' && i + 3 <= length && lower(text[i + 1]) == 'o' && lower(text[i + 2]) == 'r'
+                   && (i + 3 == length || static_cast<unsigned>(text[i + 3]) == ' ')) {
+            skip = 3;
+        }
+        if (skip > 0) {
+            if (i > start) fn(text + start, i - start);
+            start = i + skip;
+            i += skip - 1;
+        }
+    }
+    if (length > start) fn(text + start, length - start);
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QStringView>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+// Pattern ids found by a scan. Kept inline so a scan allocates nothing;
+// only the words the automaton's pattern count needs are touched.
+class PatternSet {
+public:
+    static constexpr int MaxWords = 4;
+
+    bool isEmpty() const {
+        for (uint64_t word : m_words) {
+            if (word) return false;
+        }
+        return true;
+    }
+
+    bool contains(int id) const { return m_words[std::size_t(id / 64)] & (uint64_t(1) << (id % 64)); }
+
+    // Lowest id in the set, or -1.
+    int first() const {
+        for (int word = 0; word < MaxWords; ++word) {
+            if (!m_words[std::size_t(word)]) continue;
+            int bit = 0;
+            while (!(m_words[std::size_t(word)] & (uint64_t(1) << bit))) ++bit;
+            return word * 64 + bit;
+        }
+        return -1;
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (int word = 0; word < MaxWords; ++word) {
+            uint64_t bits = m_words[std::size_t(word)];
+            for (int bit = 0; bits != 0; ++bit, bits >>= 1) {
+                if (bits & 1) fn(word * 64 + bit);
+            }
+        }
+    }
+
+    void merge(const uint64_t* words, int count) {
+        for (int i = 0; i < count; ++i) m_words[std::size_t(i)] |= words[i];
+    }
+
+private:
+    std::array<uint64_t, MaxWords> m_words{};
+};
+
+// Aho-Corasick automaton over lowercase ASCII patterns. Input is lowercased
+// on the fly and scanned once; a non-ASCII code unit resets the automaton,
+// which is what QString::toLower() followed by contains() amounts to for
+// ASCII patterns. Every state carries the mask of patterns ending there, one
+// word per 64 patterns, so a scan just ORs masks.
+class TokenAutomaton {
+public:
+    static constexpr int MaxPatterns = PatternSet::MaxWords * 64;
+
+    // Returns the pattern's id, or -1 once the automaton is full.
+    int addPattern(const std::string& pattern) {
+        Q_ASSERT_X(int(m_patterns.size()) < MaxPatterns, "TokenAutomaton::addPattern", "too many patterns");
+        if (int(m_patterns.size()) >= MaxPatterns) return -1;
+        m_patterns.push_back(pattern);
+        return int(m_patterns.size()) - 1;
+    }
+
+    void build() {
+        m_words = std::max(1, int((m_patterns.size() + 63) / 64));
+        m_classOf.fill(0);
+        int classes = 1;
+        for (const std::string& pattern : m_patterns) {
+            for (char c : pattern) {
+                unsigned char u = static_cast<unsigned char>(c);
+                if (m_classOf[u] == 0) m_classOf[u] = static_cast<uint8_t>(classes++);
+            }
+        }
+        m_classCount = classes;
+
+        std::vector<std::vector<int>> trie(1, std::vector<int>(m_classCount, -1));
+        std::vector<uint64_t> output(std::size_t(m_words), 0);
+        for (int id = 0; id < int(m_patterns.size()); ++id) {
+            int state = 0;
+            for (char c : m_patterns[id]) {
+                int cls = m_classOf[static_cast<unsigned char>(c)];
+                if (trie[state][cls] < 0) {
+                    trie[state][cls] = int(trie.size());
+                    trie.emplace_back(m_classCount, -1);
+                    output.resize(output.size() + std::size_t(m_words), 0);
+                }
+                state = trie[state][cls];
+            }
+            output[std::size_t(state) * m_words + std::size_t(id / 64)] |= uint64_t(1) << (id % 64);
+        }
+
+        const int states = int(trie.size());
+        std::vector<int> fail(states, 0);
+        std::vector<int> queue;
+        queue.reserve(states);
+        m_next.assign(std::size_t(states) * m_classCount, 0);
+        for (int cls = 1; cls < m_classCount; ++cls) {
+            int child = trie[0][cls];
+            if (child >= 0) {
+                m_next[cls] = uint16_t(child);
+                queue.push_back(child);
+            }
+        }
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            int state = queue[head];
+            for (int word = 0; word < m_words; ++word) {
+                output[std::size_t(state) * m_words + word] |= output[std::size_t(fail[state]) * m_words + word];
+            }
+            for (int cls = 1; cls < m_classCount; ++cls) {
+                int child = trie[state][cls];
+                uint16_t viaFail = m_next[std::size_t(fail[state]) * m_classCount + cls];
+                if (child >= 0) {
+                    fail[child] = viaFail;
+                    m_next[std::size_t(state) * m_classCount + cls] = uint16_t(child);
+                    queue.push_back(child);
+                } else {
+                    m_next[std::size_t(state) * m_classCount + cls] = viaFail;
+                }
+            }
+        }
+        m_output = std::move(output);
+    }
+
+    // Returns the set of pattern ids found in text. onCode sees every
+    // lowercased code unit, so callers can collect extra features in the
+    // same pass.
+    template <typename OnCode>
+    PatternSet scan(QStringView text, OnCode&& onCode) const {
+        PatternSet found;
+        std::size_t state = 0;
+        const char16_t* data = text.utf16();
+        const qsizetype size = text.size();
+        for (qsizetype i = 0; i < size; ++i) {
+            char16_t c = data[i];
+            if (c >= 'A' && c <= 'Z') c = char16_t(c + ('a' - 'A'));
+            onCode(c);
+            if (c >= 128) {
+                state = 0;
+                continue;
+            }
+            state = m_next[state * m_classCount + m_classOf[c]];
+            found.merge(&m_output[state * std::size_t(m_words)], m_words);
+        }
+        return found;
+    }
+
+    PatternSet scan(QStringView text) const {
+        return scan(text, [](char16_t) {});
+    }
+
+private:
+    std::vector<std::string> m_patterns;
+    std::array<uint8_t, 128> m_classOf{};
+    int m_classCount = 1;
+    int m_words = 1;
+    std::vector<uint16_t> m_next;
+    std::vector<uint64_t> m_output;
+};
+
+
+// Rank tables compiled once into automatons. Results match the original
+// QMap/regex implementation: cpuRank() returns the value of the
+// lexicographically first key found (QMap iteration order), gpuRank() the
+// best of "series base + first 3-4 digit number" and the exact model table.
+class HardwareRankMatcher {
+public:
+    static const HardwareRankMatcher& instance() {
+        static const HardwareRankMatcher matcher;
+        return matcher;
+    }
+
+    int cpuRank(QStringView text) const {
+        const int first = m_cpu.scan(text).first();
+        return first < 0 ? 0 : m_cpuValues[std::size_t(first)];
+    }
+
+    int gpuRank(QStringView text) const {
+        ModelNumber model;
+        const PatternSet found = m_gpu.scan(text, [&model](char16_t c) { model.feed(c); });
+        model.finish();
+
+        int bestRank = 0;
+        found.forEach([&](int id) {
+            const GpuEntry& entry = m_gpuEntries[std::size_t(id)];
+            if (entry.seriesBase >= 0) {
+                bestRank = std::max(bestRank, entry.seriesBase + model.value);
+            }
+            if (entry.modelRank >= 0) {
+                bestRank = std::max(bestRank, entry.modelRank);
+            }
+        });
+        return bestRank;
+    }
+
+private:
+    struct GpuEntry {
+        int seriesBase = -1;
+        int modelRank = -1;
+    };
+
+    // Mirrors QRegularExpression("(\\d{3,4})"): the first run of at least
+    // three ASCII digits, truncated to its first four.
+    struct ModelNumber {
+        int value = 0;
+        int run = 0;
+        int runValue = 0;
+        bool done = false;
+
+        void feed(char16_t c) {
+            if (done) return;
+            if (c >= '0' && c <= '9') {
+                if (run < 4) runValue = runValue * 10 + (c - '0');
+                ++run;
+                if (run == 4) finish();
+            } else {
+                finish();
+            }
+        }
+        void finish() {
+            if (done) return;
+            if (run >= 3) {
+                value = runValue;
+                done = true;
+            }
+            run = 0;
+            runValue = 0;
+        }
+    };
+
+    HardwareRankMatcher() {
+        std::vector<std::pair<std::string, int>> cpuRanks = {
+            {"i3", 1}, {"i5", 2}, {"i7", 3}, {"i9", 4},
+            {"ryzen 3", 1}, {"ryzen 5", 2}, {"ryzen 7", 3}, {"ryzen 9", 4}
+        };
+        std::sort(cpuRanks.begin(), cpuRanks.end());
+        for (const auto& entry : cpuRanks) {
+            m_cpu.addPattern(entry.first);
+            m_cpuValues.push_back(entry.second);
+        }
+        m_cpu.build();
+
+        const std::vector<std::pair<std::string, int>> seriesBase = {
+            {"rtx", 1000}, {"gtx", 800}, {"gt", 600},
+            {"rx", 900}, {"r9", 700}, {"r7", 600}, {"r5", 500},
+            {"arc", 850},
+            {"quadro", 700}, {"tesla", 700},
+            {"hd", 200}, {"iris", 300}, {"vega", 400},
+            {"mx", 250},
+            {"uhd", 100}, {"intel hd", 100}, {"intel iris", 200}
+        };
+        const std::vector<std::pair<std::string, int>> gpuRanks = {
+            {"gtx 750", 751}, {"gtx 950", 951}, {"gtx 960", 960}, {"gtx 970", 970}, {"gtx 1050", 1050}, {"gtx 1060", 1060}, {"gtx 1070", 1070}, {"gtx 1080", 1080},
+            {"gtx 1650", 1650}, {"gtx 1660", 1660}, {"rtx 2060", 2060}, {"rtx 2070", 2070}, {"rtx 2080", 2080}, {"rtx 3050", 3050}, {"rtx 3060", 3060}, {"rtx 3070", 3070}, {"rtx 3080", 3080}, {"rtx 4060", 4060}, {"rtx 4070", 4070}, {"rtx 4080", 4080},
+            {"rx 560", 560}, {"rx 570", 570}, {"rx 580", 580}, {"rx 590", 590}, {"rx 5500", 5500}, {"rx 5600", 5600}, {"rx 5700", 5700}, {"rx 6600", 6600}, {"rx 6700", 6700}, {"rx 6800", 6800}, {"rx 6900", 6900},
+            {"arc a380", 1380}, {"arc a750", 1750}, {"arc a770", 1770},
+            {"quadro p2000", 2200}, {"quadro rtx 4000", 4000},
+            {"mx150", 1150}, {"mx250", 1250}, {"mx330", 1330},
+            {"intel hd", 100}, {"intel iris", 200}, {"uhd", 100}
+        };
+        std::vector<std::string> keys;
+        auto entryFor = [&](const std::string& key) -> GpuEntry& {
+            auto it = std::find(keys.begin(), keys.end(), key);
+            if (it != keys.end()) return m_gpuEntries[std::size_t(it - keys.begin())];
+            keys.push_back(key);
+            m_gpu.addPattern(key);
+            m_gpuEntries.emplace_back();
+            return m_gpuEntries.back();
+        };
+        for (const auto& entry : seriesBase) entryFor(entry.first).seriesBase = entry.second;
+        for (const auto& entry : gpuRanks) entryFor(entry.first).modelRank = entry.second;
+        m_gpu.build();
+    }
+
+    TokenAutomaton m_cpu;
+    std::vector<int> m_cpuValues;
+    TokenAutomaton m_gpu;
+    std::vector<GpuEntry> m_gpuEntries;
+};
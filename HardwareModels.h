@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QHash>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QWriteLocker>
+
+
+// Interned CPU/GPU model names. Names that differ only in case or spacing
+// share one 32-bit ID, so profiles carry an integer instead of a QString and
+// "same model" is an integer compare. 0 means no model.
+using ModelId = quint32;
+
+class ModelInterner {
+public:
+    static ModelInterner& instance() {
+        static ModelInterner interner;
+        return interner;
+    }
+
+    ModelId intern(QStringView name) {
+        const QString key = name.toString().simplified().toCaseFolded();
+        if (key.isEmpty()) return 0;
+        {
+            QReadLocker locker(&m_lock);
+            auto it = m_ids.constFind(key);
+            if (it != m_ids.constEnd()) return *it;
+        }
+        QWriteLocker locker(&m_lock);
+        auto it = m_ids.constFind(key);
+        if (it != m_ids.constEnd()) return *it;
+        m_names.append(name.toString().simplified());
+        const ModelId id = ModelId(m_names.size());
+        m_ids.insert(key, id);
+        return id;
+    }
+
+    // The first spelling interned under `id`.
+    QString name(ModelId id) const {
+        QReadLocker locker(&m_lock);
+        return id > 0 && id <= ModelId(m_names.size()) ? m_names.at(qsizetype(id - 1)) : QString();
+    }
+
+private:
+    mutable QReadWriteLock m_lock;
+    QHash<QString, ModelId> m_ids;
+    QStringList m_names;
+};
+
+enum class HardwareVendor : quint8 {
+    Unknown,
+    Intel,
+    Amd,
+    Nvidia,
+    Apple,
+    Qualcomm
+};
+
+inline HardwareVendor hardwareVendor(QStringView name) {
+    if (name.contains(u"nvidia", Qt::CaseInsensitive) || name.contains(u"geforce", Qt::CaseInsensitive)
+        || name.contains(u"quadro", Qt::CaseInsensitive)) return HardwareVendor::Nvidia;
+    if (name.contains(u"amd", Qt::CaseInsensitive) || name.contains(u"radeon", Qt::CaseInsensitive)
+        || name.contains(u"ryzen", Qt::CaseInsensitive)) return HardwareVendor::Amd;
+    if (name.contains(u"intel", Qt::CaseInsensitive) || name.contains(u"core", Qt::CaseInsensitive)
+        || name.contains(u"pentium", Qt::CaseInsensitive) || name.contains(u"celeron", Qt::CaseInsensitive)) return HardwareVendor::Intel;
+    if (name.contains(u"apple", Qt::CaseInsensitive)) return HardwareVendor::Apple;
+    if (name.contains(u"snapdragon", Qt::CaseInsensitive) || name.contains(u"adreno", Qt::CaseInsensitive)) return HardwareVendor::Qualcomm;
+    return HardwareVendor::Unknown;
+}
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QProcess>
+#include <QSet>
+#include <QStorageInfo>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <vector>
+#include "DxDiagParser.h"
+#include "DxDiagReport.h"
+
+
+// What a hardware probe found. Backends either fill `report` directly, in
+// the dxdiag section model with just the fields the comparison reads, or
+// write a dxdiag report and name it in `captureFile`.
+struct HardwareProbeResult {
+    DxDiagReport report;
+    QString captureFile;
+};
+
+class HardwareProbe {
+public:
+    virtual ~HardwareProbe() = default;
+    virtual QString name() const = 0;
+    virtual bool probe(HardwareProbeResult& result, QString& errorMessage) = 0;
+};
+
+// Reads the processor and memory from /proc, display adapters from
+// /sys/class/drm and free space from the mounted volumes. Takes a few
+// milliseconds, against 10-30 s for dxdiag. `root` lets it run against a
+// copy of those trees.
+class LinuxHardwareProbe : public HardwareProbe {
+public:
+    explicit LinuxHardwareProbe(const QString& root = QStringLiteral("/")) : m_root(root.endsWith('/') ? root : root + '/') {}
+
+    QString name() const override { return QStringLiteral("/proc and /sys"); }
+
+    bool probe(HardwareProbeResult& result, QString& errorMessage) override {
+        QElapsedTimer timer;
+        timer.start();
+        DxDiagReport::Builder report;
+        if (!probeSystem(report)) {
+            errorMessage = "No processor or memory information in " + m_root + "proc";
+            return false;
+        }
+        probeDisplays(report);
+        probeDisks(report);
+        result.report = report.build();
+        qDebug() << "Probed hardware from /proc and /sys in" << timer.elapsed() << "ms";
+        return true;
+    }
+
+private:
+    QByteArray readFile(const QString& path) const {
+        QFile file(m_root + path);
+        if (!file.open(QIODevice::ReadOnly)) return {};
+        return file.readAll().trimmed();
+    }
+
+    // "key<TAB>: value" lines of /proc/cpuinfo and /proc/meminfo.
+    static QByteArray procValue(const QByteArray& text, QByteArrayView key, qsizetype* from = nullptr) {
+        qsizetype pos = from ? *from : 0;
+        while (pos < text.size()) {
+            qsizetype end = text.indexOf('\n', pos);
+            if (end < 0) end = text.size();
+            const QByteArrayView line(text.constData() + pos, end - pos);
+            pos = end + 1;
+            const qsizetype colon = line.indexOf(':');
+            if (colon > 0 && line.first(colon).trimmed() == key) {
+                if (from) *from = pos;
+                return line.sliced(colon + 1).trimmed().toByteArray();
+            }
+        }
+        if (from) *from = text.size();
+        return {};
+    }
+
+    const DxDiagSectionSchema& schema(QStringView element) const {
+        const DxDiagSectionSchema* section = findDxDiagSection(element);
+        return section ? *section : dxDiagSchema().first();
+    }
+
+    // Processor and Memory, formatted the way dxdiag writes them.
+    bool probeSystem(DxDiagReport::Builder& report) const {
+        const QByteArray cpuinfo = readFile("proc/cpuinfo");
+        const QByteArray meminfo = readFile("proc/meminfo");
+        QByteArray model = procValue(cpuinfo, "model name");
+        if (model.isEmpty()) model = procValue(cpuinfo, "Hardware");
+        const qint64 memKb = procValue(meminfo, "MemTotal").split(' ').first().toLongLong();
+        if (model.isEmpty() && memKb <= 0) return false;
+
+        DxDiagRecordBuilder builder(report, schema(u"SystemInformation"));
+        if (!model.isEmpty()) {
+            int cpus = 0;
+            for (qsizetype pos = 0; pos < cpuinfo.size();) {
+                if (procValue(cpuinfo, "processor", &pos).isEmpty()) break;
+                ++cpus;
+            }
+            QString processor = QString::fromUtf8(model).simplified();
+            if (cpus > 0) processor += QString(" (%1 CPUs)").arg(cpus);
+            const double mhz = procValue(cpuinfo, "cpu MHz").toDouble();
+            if (mhz > 0) processor += QString(", ~%1GHz").arg(mhz / 1000.0, 0, 'f', 1);
+            builder.setValue(builder.fieldIndex(u"Processor"), processor);
+        }
+        if (memKb > 0) {
+            // MemTotal leaves out firmware and kernel reservations; round up
+            // to the installed size dxdiag would report.
+            const qint64 memMb = (memKb / 1024 + 1023) / 1024 * 1024;
+            builder.setValue(builder.fieldIndex(u"Memory"), QString::number(memMb) + "MB RAM");
+        }
+        const QByteArray osName = procValue(readFile("etc/os-release").replace('=', ':'), "PRETTY_NAME");
+        if (!osName.isEmpty()) {
+            builder.setValue(builder.fieldIndex(u"OperatingSystem"), QString::fromUtf8(osName).remove('"'));
+        }
+        builder.flushRecord();
+        return true;
+    }
+
+    static QString vendorName(quint32 vendorId) {
+        switch (vendorId) {
+        case 0x10DE: return QStringLiteral("NVIDIA");
+        case 0x1002: return QStringLiteral("AMD");
+        case 0x8086: return QStringLiteral("Intel");
+        case 0x5143: return QStringLiteral("Qualcomm");
+        default: return QString();
+        }
+    }
+
+    // Device name from the PCI ID database ("GA107M [GeForce RTX 2050]"
+    // becomes "GeForce RTX 2050").
+    QString pciDeviceName(quint32 vendorId, quint32 deviceId) const {
+        for (const char* path : {"usr/share/hwdata/pci.ids", "usr/share/misc/pci.ids", "usr/share/pci.ids"}) {
+            QFile file(m_root + path);
+            if (!file.open(QIODevice::ReadOnly)) continue;
+            const QByteArray ids = file.readAll();
+            const QByteArray vendorLine = '\n' + QByteArray::number(vendorId, 16).rightJustified(4, '0') + "  ";
+            const QByteArray deviceLine = '\t' + QByteArray::number(deviceId, 16).rightJustified(4, '0') + "  ";
+            qsizetype pos = ids.indexOf(vendorLine);
+            if (pos < 0) return QString();
+            pos = ids.indexOf('\n', pos + 1) + 1;
+            while (pos > 0 && pos < ids.size() && (ids.at(pos) == '\t' || ids.at(pos) == '#')) {
+                qsizetype end = ids.indexOf('\n', pos);
+                if (end < 0) end = ids.size();
+                if (QByteArrayView(ids.constData() + pos, end - pos).startsWith(deviceLine)) {
+                    QString name = QString::fromUtf8(ids.constData() + pos + deviceLine.size(), end - pos - deviceLine.size());
+                    const qsizetype open = name.indexOf('[');
+                    const qsizetype close = name.lastIndexOf(']');
+                    return open >= 0 && close > open ? name.mid(open + 1, close - open - 1) : name;
+                }
+                pos = end + 1;
+            }
+            return QString();
+        }
+        return QString();
+    }
+
+    void probeDisplays(DxDiagReport::Builder& report) const {
+        struct Adapter {
+            QString name;
+            quint32 vendorId;
+            quint32 deviceId;
+            QString slot;
+            QString driver;
+            qint64 vramBytes;
+        };
+        QList<Adapter> adapters;
+        QSet<QString> seenSlots;
+        const QDir drm(m_root + "sys/class/drm");
+        for (const QString& card : drm.entryList({"card*"}, QDir::Dirs | QDir::System | QDir::NoDotAndDotDot, QDir::Name)) {
+            if (card.contains('-')) continue;  // connectors: card0-HDMI-A-1
+            const QString device = "sys/class/drm/" + card + "/device/";
+            bool ok = false;
+            Adapter adapter;
+            adapter.vendorId = readFile(device + "vendor").toUInt(&ok, 16);
+            if (!ok) continue;
+            adapter.deviceId = readFile(device + "device").toUInt(nullptr, 16);
+            const QByteArray uevent = readFile(device + "uevent").replace('=', ':');
+            adapter.slot = QString::fromLatin1(procValue(uevent, "PCI_SLOT_NAME"));
+            adapter.driver = QString::fromLatin1(procValue(uevent, "DRIVER"));
+            adapter.vramBytes = readFile(device + "mem_info_vram_total").toLongLong();
+            if (!adapter.slot.isEmpty() && seenSlots.contains(adapter.slot)) continue;
+            seenSlots.insert(adapter.slot);
+
+            const QByteArray nvidiaInfo = readFile("proc/driver/nvidia/gpus/" + adapter.slot + "/information");
+            adapter.name = QString::fromUtf8(procValue(nvidiaInfo, "Model")).simplified();
+            if (adapter.name.isEmpty()) {
+                const QString vendor = vendorName(adapter.vendorId);
+                const QString pciName = pciDeviceName(adapter.vendorId, adapter.deviceId);
+                if (pciName.isEmpty()) {
+                    adapter.name = QString("%1 0x%2").arg(vendor.isEmpty() ? "GPU" : vendor).arg(adapter.deviceId, 4, 16, QChar('0'));
+                } else {
+                    adapter.name = pciName.startsWith(vendor) ? pciName : vendor + " " + pciName;
+                }
+            }
+            adapters.append(adapter);
+        }
+
+        DxDiagRecordBuilder builder(report, schema(u"DisplayDevices"));
+        auto set = [&builder](QStringView element, const QString& value) {
+            if (!value.isEmpty()) builder.setValue(builder.fieldIndex(element), value);
+        };
+        for (const Adapter& adapter : adapters) {
+            set(u"CardName", adapter.name);
+            set(u"Manufacturer", vendorName(adapter.vendorId));
+            set(u"VendorID", "0x" + QString("%1").arg(adapter.vendorId, 4, 16, QChar('0')).toUpper());
+            set(u"DeviceID", "0x" + QString("%1").arg(adapter.deviceId, 4, 16, QChar('0')).toUpper());
+            set(u"DeviceKey", QString("PCI\\VEN_%1&DEV_%2\\%3").arg(adapter.vendorId, 4, 16, QChar('0')).arg(adapter.deviceId, 4, 16, QChar('0')).arg(adapter.slot).toUpper());
+            if (adapter.vramBytes > 0) set(u"DedicatedMemory", QString::number(adapter.vramBytes / (1024 * 1024)) + " MB");
+            set(u"DriverVersion", QString::fromLatin1(readFile("sys/module/" + adapter.driver + "/version")));
+            if (!adapter.driver.isEmpty()) set(u"DriverModel", "Linux DRM (" + adapter.driver + ")");
+            if (adapters.size() > 1) {
+                // dxdiag only labels adapters on hybrid systems.
+                const bool discrete = adapter.vendorId == 0x10DE || adapter.vramBytes >= 1024LL * 1024 * 1024;
+                set(u"HybridGraphicsGPUType", discrete ? QStringLiteral("Discrete") : QStringLiteral("Integrated"));
+            }
+            builder.flushRecord();
+        }
+    }
+
+    // Local block-device volumes, one record each, sizes in bytes as in
+    // dxdiag /x.
+    void probeDisks(DxDiagReport::Builder& report) const {
+        DxDiagRecordBuilder builder(report, schema(u"LogicalDisks"));
+        QSet<QByteArray> devices;
+        for (const QStorageInfo& volume : QStorageInfo::mountedVolumes()) {
+            const QByteArray device = volume.device();
+            if (!volume.isValid() || !volume.isReady() || volume.isReadOnly()
+                || !device.startsWith("/dev/") || device.startsWith("/dev/loop") || devices.contains(device)) {
+                continue;
+            }
+            devices.insert(device);
+            builder.setValue(builder.fieldIndex(u"DriveLetter"), volume.rootPath());
+            builder.setValue(builder.fieldIndex(u"FreeSpace"), QString::number(volume.bytesAvailable()));
+            builder.setValue(builder.fieldIndex(u"MaxSpace"), QString::number(volume.bytesTotal()));
+            builder.setValue(builder.fieldIndex(u"FileSystem"), QString::fromLatin1(volume.fileSystemType()));
+            builder.setValue(builder.fieldIndex(u"Model"), QString::fromLocal8Bit(device));
+            builder.flushRecord();
+        }
+    }
+
+    QString m_root;
+};
+
+// How long dxdiag.exe may run before it is killed: SYSREQ_DXDIAG_TIMEOUT_MS,
+// else two minutes. A normal run takes 10-30 s.
+inline int dxdiagTimeoutMs() {
+    bool ok = false;
+    const int timeoutMs = qEnvironmentVariableIntValue("SYSREQ_DXDIAG_TIMEOUT_MS", &ok);
+    return ok && timeoutMs > 0 ? timeoutMs : 120000;
+}
+
+// The fallback: runs dxdiag.exe /x, which enumerates every device on the
+// machine and takes tens of seconds. probe() blocks until it exits or the
+// deadline passes; the GUI drives the same command asynchronously.
+class DxDiagHardwareProbe : public HardwareProbe {
+public:
+    explicit DxDiagHardwareProbe(const QString& outputFile = QStringLiteral("dxdiag_output.xml")) : m_outputFile(outputFile) {}
+
+    QString name() const override { return QStringLiteral("dxdiag.exe"); }
+
+    static QString program() { return QStringLiteral("dxdiag.exe"); }
+    QStringList arguments() const { return {QStringLiteral("/x"), m_outputFile}; }
+    const QString& outputFile() const { return m_outputFile; }
+
+    bool probe(HardwareProbeResult& result, QString& errorMessage) override {
+        qDebug() << "Running command:" << program() << arguments();
+        QProcess dxdiagProcess;
+        dxdiagProcess.start(program(), arguments());
+        if (!dxdiagProcess.waitForFinished(dxdiagTimeoutMs()) && dxdiagProcess.state() != QProcess::NotRunning) {
+            dxdiagProcess.kill();
+            dxdiagProcess.waitForFinished();
+            errorMessage = "dxdiag.exe did not finish within " + QString::number(dxdiagTimeoutMs() / 1000) + " s";
+            return false;
+        }
+
+        if (dxdiagProcess.error() == QProcess::FailedToStart || dxdiagProcess.exitCode() != 0) {
+            qDebug() << "Error running dxdiag.exe:";
+            qDebug() << dxdiagProcess.readAllStandardError();
+            errorMessage = "Failed to run dxdiag.exe";
+            return false;
+        }
+        qDebug() << "dxdiag.exe finished successfully.";
+        result.captureFile = m_outputFile;
+        return true;
+    }
+
+private:
+    QString m_outputFile;
+};
+
+// Backends in order of preference. SYSREQ_PROBE=dxdiag skips the native one.
+inline std::vector<std::unique_ptr<HardwareProbe>> createNativeHardwareProbes() {
+    std::vector<std::unique_ptr<HardwareProbe>> probes;
+#if defined(Q_OS_LINUX)
+    if (qEnvironmentVariable("SYSREQ_PROBE") != "dxdiag") {
+        probes.push_back(std::make_unique<LinuxHardwareProbe>());
+    }
+#endif
+    return probes;
+}
+
+inline std::vector<std::unique_ptr<HardwareProbe>> createHardwareProbes() {
+    std::vector<std::unique_ptr<HardwareProbe>> probes = createNativeHardwareProbes();
+    probes.push_back(std::make_unique<DxDiagHardwareProbe>());
+    return probes;
+}
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// Incremental JSON reader for response bodies that arrive in pieces. It is
+// fed each chunk as it comes off the socket and reports only the scalars
+// whose path matches one of its patterns ("results.*.platforms.*.requirements.minimum",
+// where * matches any key or index). Containers that cannot lead to a match
+// are skipped by a brace counter, and so are strings outside the patterns,
+// without being decoded. Only the token in progress is buffered, so memory
+// stays flat however large the document is.
+//
+// Standard library only, like DxDiagTextScanner.h.
+struct JsonPathComponent {
+    std::string key;
+    std::size_t index = 0;
+    bool isIndex = false;
+};
+
+struct JsonPullValue {
+    enum class Type {
+        Null,
+        Bool,
+        Number,
+        String
+    };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string text;  // UTF-8, unescaped
+};
+
+class JsonPullReader {
+public:
+    using Path = std::vector<JsonPathComponent>;
+    using Handler = std::function<void(const Path& path, const JsonPullValue& value)>;
+
+    JsonPullReader(const std::vector<std::string>& patterns, Handler handler) : m_handler(std::move(handler)) {
+        for (const std::string& pattern : patterns) {
+            std::vector<std::string> parts;
+            std::size_t begin = 0;
+            while (begin <= pattern.size()) {
+                std::size_t end = pattern.find('.', begin);
+                if (end == std::string::npos) end = pattern.size();
+                parts.push_back(pattern.substr(begin, end - begin));
+                begin = end + 1;
+            }
+            m_patterns.push_back(parts);
+        }
+    }
+
+    // Returns false once the input is malformed; later chunks are ignored.
+    bool feed(const char* data, std::size_t size) {
+        if (m_failed) return false;
+        m_buffer.append(data, size);
+        std::size_t pos = 0;
+        while (!m_failed) {
+            if (m_skipping) {
+                if (!skip(pos)) break;
+                valueDone();
+                continue;
+            }
+            while (pos < m_buffer.size() && isSpace(m_buffer[pos])) ++pos;
+            if (pos == m_buffer.size()) break;
+            const char c = m_buffer[pos];
+            bool complete = true;
+            switch (m_expect) {
+            case Expect::Done:
+                m_failed = true;
+                break;
+            case Expect::KeyOrEnd:
+                if (c == '}') {
+                    ++pos;
+                    closeContainer();
+                    break;
+                }
+                [[fallthrough]];
+            case Expect::Key:
+                if (c != '"') {
+                    m_failed = true;
+                } else if ((complete = readString(pos, m_path.back().key))) {
+                    m_expect = Expect::Colon;
+                }
+                break;
+            case Expect::Colon:
+                if (c != ':') {
+                    m_failed = true;
+                } else {
+                    ++pos;
+                    m_expect = Expect::Value;
+                }
+                break;
+            case Expect::CommaOrEnd:
+                if (c == ',') {
+                    ++pos;
+                    JsonPathComponent& last = m_path.back();
+                    if (last.isIndex) {
+                        ++last.index;
+                        m_expect = Expect::Value;
+                    } else {
+                        m_expect = Expect::Key;
+                    }
+                } else if (c == (m_path.back().isIndex ? ']' : '}')) {
+                    ++pos;
+                    closeContainer();
+                } else {
+                    m_failed = true;
+                }
+                break;
+            case Expect::ValueOrEnd:
+                if (c == ']') {
+                    ++pos;
+                    closeContainer();
+                    break;
+                }
+                [[fallthrough]];
+            case Expect::Value:
+                complete = beginValue(pos);
+                break;
+            }
+            if (!complete) break;
+        }
+        m_buffer.erase(0, pos);
+        return !m_failed;
+    }
+
+    // True once a whole document has been read.
+    bool atEnd() const { return m_expect == Expect::Done && !m_failed; }
+    bool failed() const { return m_failed; }
+    std::size_t bufferedBytes() const { return m_buffer.size(); }
+
+private:
+    enum class Expect {
+        Value,
+        ValueOrEnd,
+        KeyOrEnd,
+        Key,
+        Colon,
+        CommaOrEnd,
+        Done
+    };
+
+    static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    // Does some pattern match the current path exactly (or, with `prefix`,
+    // continue below it)?
+    bool matches(bool prefix) const {
+        for (const std::vector<std::string>& pattern : m_patterns) {
+            if (prefix ? pattern.size() <= m_path.size() : pattern.size() != m_path.size()) continue;
+            bool ok = true;
+            for (std::size_t i = 0; ok && i < m_path.size(); ++i) {
+                const std::string& part = pattern[i];
+                const JsonPathComponent& component = m_path[i];
+                ok = part == "*" || (component.isIndex ? part == std::to_string(component.index) : part == component.key);
+            }
+            if (ok) return true;
+        }
+        return false;
+    }
+
+    bool beginValue(std::size_t& pos) {
+        const char c = m_buffer[pos];
+        if (c == '{' || c == '[') {
+            ++pos;
+            if (matches(true)) {
+                JsonPathComponent component;
+                component.isIndex = c == '[';
+                m_path.push_back(component);
+                m_expect = c == '{' ? Expect::KeyOrEnd : Expect::ValueOrEnd;
+            } else {
+                m_skipping = true;
+                m_skipDepth = 1;
+            }
+            return true;
+        }
+        if (c == '"') {
+            if (!matches(false)) {
+                ++pos;
+                m_skipping = true;
+                m_skipDepth = 0;
+                m_skipString = true;
+                return true;
+            }
+            JsonPullValue value;
+            value.type = JsonPullValue::Type::String;
+            if (!readString(pos, value.text)) return false;
+            m_handler(m_path, value);
+            valueDone();
+            return true;
+        }
+
+        std::size_t end = pos;
+        while (end < m_buffer.size() && !isSpace(m_buffer[end]) && m_buffer[end] != ',' && m_buffer[end] != '}' && m_buffer[end] != ']') ++end;
+        if (end == m_buffer.size()) return false;
+        const std::string_view token(m_buffer.data() + pos, end - pos);
+        JsonPullValue value;
+        if (token == "true" || token == "false") {
+            value.type = JsonPullValue::Type::Bool;
+            value.boolean = token == "true";
+        } else if (token == "null") {
+            value.type = JsonPullValue::Type::Null;
+        } else {
+            value.type = JsonPullValue::Type::Number;
+            const std::from_chars_result result = std::from_chars(token.data(), token.data() + token.size(), value.number);
+            if (result.ec != std::errc() || result.ptr != token.data() + token.size()) {
+                m_failed = true;
+                return true;
+            }
+        }
+        pos = end;
+        if (matches(false)) m_handler(m_path, value);
+        valueDone();
+        return true;
+    }
+
+    // Consumes the rest of a skipped value. Returns false if the chunk ends
+    // first; the state carries over to the next one.
+    bool skip(std::size_t& pos) {
+        for (; pos < m_buffer.size(); ++pos) {
+            const char c = m_buffer[pos];
+            if (m_skipString) {
+                if (m_skipEscape) {
+                    m_skipEscape = false;
+                } else if (c == '\\') {
+                    m_skipEscape = true;
+                } else if (c == '"') {
+                    m_skipString = false;
+                    if (m_skipDepth == 0) {
+                        ++pos;
+                        return true;
+                    }
+                }
+            } else if (c == '"') {
+                m_skipString = true;
+            } else if (c == '{' || c == '[') {
+                ++m_skipDepth;
+            } else if ((c == '}' || c == ']') && --m_skipDepth == 0) {
+                ++pos;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Decodes the string starting at the quote at `pos`. Returns false,
+    // leaving `pos` alone, if its closing quote has not arrived yet.
+    bool readString(std::size_t& pos, std::string& out) {
+        std::size_t end = pos + 1 + m_scanned;
+        bool escape = m_scanEscape;
+        for (; end < m_buffer.size(); ++end) {
+            if (escape) {
+                escape = false;
+            } else if (m_buffer[end] == '\\') {
+                escape = true;
+            } else if (m_buffer[end] == '"') {
+                break;
+            }
+        }
+        if (end == m_buffer.size()) {
+            m_scanned = end - pos - 1;
+            m_scanEscape = escape;
+            return false;
+        }
+        m_scanned = 0;
+        m_scanEscape = false;
+
+        out.clear();
+        for (std::size_t i = pos + 1; i < end; ++i) {
+            const char c = m_buffer[i];
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            const char e = m_buffer[++i];
+            switch (e) {
+            case '"': case '\\': case '/': out.push_back(e); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                char32_t code = 0;
+                if (!readHex(i + 1, end, code)) {
+                    m_failed = true;
+                    return true;
+                }
+                i += 4;
+                char32_t low = 0;
+                if (code >= 0xD800 && code < 0xDC00 && i + 6 < end && m_buffer[i + 1] == '\\' && m_buffer[i + 2] == 'u'
+                    && readHex(i + 3, end, low) && low >= 0xDC00 && low < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default:
+                m_failed = true;
+                return true;
+            }
+        }
+        pos = end + 1;
+        return true;
+    }
+
+    bool readHex(std::size_t begin, std::size_t end, char32_t& code) const {
+        if (begin + 4 > end) return false;
+        unsigned value = 0;
+        const std::from_chars_result result = std::from_chars(m_buffer.data() + begin, m_buffer.data() + begin + 4, value, 16);
+        if (result.ec != std::errc() || result.ptr != m_buffer.data() + begin + 4) return false;
+        code = value;
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, char32_t code) {
+        if (code < 0x80) {
+            out.push_back(char(code));
+        } else if (code < 0x800) {
+            out.push_back(char(0xC0 | (code >> 6)));
+            out.push_back(char(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out.push_back(char(0xE0 | (code >> 12)));
+            out.push_back(char(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(char(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back(char(0xF0 | (code >> 18)));
+            out.push_back(char(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(char(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(char(0x80 | (code & 0x3F)));
+        }
+    }
+
+    void valueDone() {
+        m_skipping = false;
+        m_expect = m_path.empty() ? Expect::Done : Expect::CommaOrEnd;
+    }
+
+    void closeContainer() {
+        m_path.pop_back();
+        valueDone();
+    }
+
+    std::vector<std::vector<std::string>> m_patterns;
+    Handler m_handler;
+    std::string m_buffer;
+    Path m_path;
+    Expect m_expect = Expect::Value;
+    bool m_failed = false;
+
+    bool m_skipping = false;
+    bool m_skipString = false;
+    bool m_skipEscape = false;
+    int m_skipDepth = 0;
+
+    // How far a string that spans chunks has already been scanned.
+    std::size_t m_scanned = 0;
+    bool m_scanEscape = false;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QNetworkAccessManager>
+#include <QThreadStorage>
+
+
+// One long-lived QNetworkAccessManager per thread. Requests made through it
+// share its connection pool, HTTP/2 sessions and TLS session cache, which a
+// manager created per request throws away. It is deleted when the thread
+// exits.
+inline QNetworkAccessManager* sharedNetworkAccessManager() {
+    static QThreadStorage<QNetworkAccessManager*> managers;
+    if (!managers.hasLocalData()) {
+        managers.setLocalData(new QNetworkAccessManager());
+    }
+    return managers.localData();
+}
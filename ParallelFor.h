@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include "TaskScheduler.h"
+
+
+// Splits [0, count) into `threads` contiguous chunks and runs fn(begin, end)
+// for each on TaskScheduler's pool, so batch paths share its threads instead
+// of starting their own per call. The calling thread takes chunks too and
+// returns once all of them have run; since it can always finish the work
+// alone, a call from a pool job cannot deadlock. Parallelism is bounded by
+// the pool size (SYSREQ_WORKERS) whatever `threads` asks for. Chunks are
+// queued at `priority`; the default keeps batch work behind captures and
+// searches the GUI is waiting on.
+template <typename Fn>
+void parallelFor(std::size_t count, int threads, Fn fn, TaskPriority priority = TaskPriority::Background)
+{
+    if (count == 0) {
+        return;
+    }
+    std::size_t workers = static_cast<std::size_t>(std::max(1, threads));
+    workers = std::min(workers, count);
+    if (workers == 1) {
+        fn(std::size_t(0), count);
+        return;
+    }
+
+    // Shared with the jobs, which may only get to run after the call has
+    // returned; they then find no chunk left and never touch fn.
+    struct Group {
+        std::size_t count = 0;
+        std::size_t chunk = 0;
+        std::size_t chunks = 0;
+        std::atomic<std::size_t> next{0};
+        std::size_t done = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto group = std::make_shared<Group>();
+    group->count = count;
+    group->chunk = (count + workers - 1) / workers;
+    group->chunks = (count + group->chunk - 1) / group->chunk;
+
+    Fn* body = &fn;
+    auto work = [group, body]() {
+        for (;;) {
+            const std::size_t index = group->next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= group->chunks) return;
+            const std::size_t begin = index * group->chunk;
+            (*body)(begin, std::min(group->count, begin + group->chunk));
+            std::lock_guard<std::mutex> lock(group->mutex);
+            if (++group->done == group->chunks) {
+                group->finished.notify_all();
+            }
+        }
+    };
+    for (std::size_t i = 0; i + 1 < group->chunks; ++i) {
+        TaskScheduler::instance().post(priority, work);
+    }
+    work();
+    std::unique_lock<std::mutex> lock(group->mutex);
+    group->finished.wait(lock, [&]() { return group->done == group->chunks; });
+}
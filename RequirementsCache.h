@@ -0,0 +1,202 @@
+#pragma once
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QString>
+#include <optional>
+#include "GameRequirements.h"
+
+
+// Requirements looked up from Steam or RAWG, remembered in memory and on
+// disk (one JSON file per key). Entries older than the TTL are revalidated
+// with If-None-Match / If-Modified-Since, so an unchanged title costs a 304
+// instead of a full download and parse.
+struct CachedRequirements {
+    GameRequirements requirements;
+    QString gameName;
+    bool found = false;
+    QByteArray payload;
+    QByteArray etag;
+    QByteArray lastModified;
+    QDateTime fetchedAt;
+};
+
+class RequirementsCache {
+public:
+    static RequirementsCache& instance() {
+        static RequirementsCache cache(defaultDirectory(), defaultTtlSeconds());
+        return cache;
+    }
+
+    // SYSREQ_CACHE_DIR, else <cache location>/requirements.
+    static QString defaultDirectory() {
+        QString dir = qEnvironmentVariable("SYSREQ_CACHE_DIR");
+        if (dir.isEmpty()) {
+            dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/requirements";
+        }
+        return dir;
+    }
+
+    // SYSREQ_CACHE_TTL in seconds, else one day.
+    static qint64 defaultTtlSeconds() {
+        bool ok = false;
+        qint64 ttl = qEnvironmentVariable("SYSREQ_CACHE_TTL").toLongLong(&ok);
+        return ok && ttl >= 0 ? ttl : 24 * 60 * 60;
+    }
+
+    static QString steamKey(const QString& appId) { return "steam:" + appId.trimmed(); }
+
+    // RAWG searches by name, so "Half-Life 2" and "half life 2 " share an entry.
+    static QString rawgKey(const QString& gameName) {
+        static const QRegularExpression punctuation("[^a-z0-9]+");
+        QString name = gameName.toLower();
+        name.replace(punctuation, " ");
+        return "rawg:" + name.simplified();
+    }
+
+    RequirementsCache(const QString& directory, qint64 ttlSeconds) : m_directory(directory), m_ttlSeconds(ttlSeconds) {
+        QDir().mkpath(m_directory);
+    }
+
+    std::optional<CachedRequirements> lookup(const QString& key) {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.constFind(key);
+        if (it != m_entries.constEnd()) {
+            return *it;
+        }
+        std::optional<CachedRequirements> entry = readEntry(key);
+        if (entry) {
+            m_entries.insert(key, *entry);
+        }
+        return entry;
+    }
+
+    bool isFresh(const CachedRequirements& entry) const {
+        return entry.fetchedAt.isValid() && entry.fetchedAt.secsTo(QDateTime::currentDateTimeUtc()) < m_ttlSeconds;
+    }
+
+    // fetchedAt is when the entry was confirmed current; normally now.
+    void store(const QString& key, CachedRequirements entry, const QDateTime& fetchedAt = QDateTime::currentDateTimeUtc()) {
+        entry.fetchedAt = fetchedAt;
+        QMutexLocker locker(&m_mutex);
+        m_entries.insert(key, entry);
+        writeEntry(key, entry);
+    }
+
+    // Stores a 200 response together with its validators.
+    void storeReply(const QString& key, QNetworkReply* reply, const QByteArray& payload,
+                    const GameRequirements& requirements, const QString& gameName, bool found) {
+        CachedRequirements entry;
+        entry.requirements = requirements;
+        entry.gameName = gameName;
+        entry.found = found;
+        entry.payload = payload;
+        entry.etag = reply->rawHeader("ETag");
+        entry.lastModified = reply->rawHeader("Last-Modified");
+        store(key, entry);
+    }
+
+    // Forgets every entry, in memory and on disk.
+    void clear() {
+        QMutexLocker locker(&m_mutex);
+        m_entries.clear();
+        QDir dir(m_directory);
+        for (const QString& name : dir.entryList({"*.json"}, QDir::Files)) {
+            dir.remove(name);
+        }
+    }
+
+    static void addValidators(QNetworkRequest& request, const CachedRequirements& entry) {
+        if (!entry.etag.isEmpty()) {
+            request.setRawHeader("If-None-Match", entry.etag);
+        }
+        if (!entry.lastModified.isEmpty()) {
+            request.setRawHeader("If-Modified-Since", entry.lastModified);
+        }
+    }
+
+    static bool isNotModified(QNetworkReply* reply) {
+        return reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304;
+    }
+
+private:
+    QString filePath(const QString& key) const {
+        return m_directory + "/" + QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex()) + ".json";
+    }
+
+    std::optional<CachedRequirements> readEntry(const QString& key) const {
+        QFile file(filePath(key));
+        if (!file.open(QIODevice::ReadOnly)) {
+            return std::nullopt;
+        }
+        QJsonObject obj = QJsonDocument::fromJson(file.readAll()).object();
+        if (obj["key"].toString() != key) {
+            return std::nullopt;
+        }
+        CachedRequirements entry;
+        entry.requirements.cpu = obj["cpu"].toString();
+        entry.requirements.gpu = obj["gpu"].toString();
+        entry.requirements.ram = obj["ram"].toString();
+        entry.requirements.storage = obj["storage"].toString();
+        for (const QJsonValue& value : obj["tiers"].toArray()) {
+            const QJsonObject tier = value.toObject();
+            entry.requirements.tiers.append({tier["name"].toString(), tier["cpu"].toString(), tier["gpu"].toString(),
+                                             tier["ram"].toString(), tier["storage"].toString()});
+        }
+        entry.gameName = obj["name"].toString();
+        entry.found = obj["found"].toBool();
+        entry.payload = obj["payload"].toString().toUtf8();
+        entry.etag = obj["etag"].toString().toLatin1();
+        entry.lastModified = obj["lastModified"].toString().toLatin1();
+        entry.fetchedAt = QDateTime::fromMSecsSinceEpoch(qint64(obj["fetchedAt"].toDouble())).toUTC();
+        return entry;
+    }
+
+    void writeEntry(const QString& key, const CachedRequirements& entry) const {
+        QJsonObject obj;
+        obj["key"] = key;
+        obj["cpu"] = entry.requirements.cpu;
+        obj["gpu"] = entry.requirements.gpu;
+        obj["ram"] = entry.requirements.ram;
+        obj["storage"] = entry.requirements.storage;
+        QJsonArray tiers;
+        for (const RequirementTier& tier : entry.requirements.tiers) {
+            tiers.append(QJsonObject{{"name", tier.name}, {"cpu", tier.cpu}, {"gpu", tier.gpu}, {"ram", tier.ram}, {"storage", tier.storage}});
+        }
+        obj["tiers"] = tiers;
+        obj["name"] = entry.gameName;
+        obj["found"] = entry.found;
+        obj["payload"] = QString::fromUtf8(entry.payload);
+        obj["etag"] = QString::fromLatin1(entry.etag);
+        obj["lastModified"] = QString::fromLatin1(entry.lastModified);
+        obj["fetchedAt"] = double(entry.fetchedAt.toMSecsSinceEpoch());
+
+        QSaveFile file(filePath(key));
+        if (!file.open(QIODevice::WriteOnly)) {
+            qDebug() << "Could not write requirements cache entry:" << file.fileName();
+            return;
+        }
+        file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+
+    QString m_directory;
+    qint64 m_ttlSeconds;
+    QMutex m_mutex;
+    QHash<QString, CachedRequirements> m_entries;
+};
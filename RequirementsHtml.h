@@ -0,0 +1,158 @@
+#pragma once
+
+#include <QChar>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <initializer_list>
+#include "GameRequirements.h"
+
+
+// Steam's pc_requirements blocks are small HTML lists:
+//   <strong>Minimum:</strong><br><ul class="bb_ul"><li><strong>Processor:</strong> i5-4460<br></li>...
+// The tokenizer walks one block once. Tags are dropped, with <br>, <li>,
+// <p> and friends ending a line. Entities are decoded, and every non-empty
+// line becomes a field, labelled with the text before its first colon. A
+// known label later in a line ("... 64-bit Memory: 8 GB") starts a new
+// field, as in blocks that were flattened to plain text.
+struct RequirementsField {
+    QString label;
+    QString value;
+};
+
+inline char32_t decodeHtmlEntity(QStringView entity) {
+    if (entity.startsWith(u'#')) {
+        bool ok = false;
+        const uint code = entity.size() > 1 && (entity[1] == u'x' || entity[1] == u'X')
+            ? entity.mid(2).toUInt(&ok, 16) : entity.mid(1).toUInt(&ok, 10);
+        return ok && code > 0 && code <= 0x10FFFF ? char32_t(code) : 0;
+    }
+    static const struct { const char16_t* name; char32_t code; } named[] = {
+        {u"amp", u'&'}, {u"lt", u'<'}, {u"gt", u'>'}, {u"quot", u'"'}, {u"apos", u'\''},
+        {u"nbsp", u' '}, {u"reg", 0xAE}, {u"trade", 0x2122}, {u"copy", 0xA9}, {u"ndash", 0x2013}, {u"mdash", 0x2014}
+    };
+    for (const auto& entry : named) {
+        if (entity == QStringView(entry.name)) return entry.code;
+    }
+    return 0;
+}
+
+inline QList<RequirementsField> tokenizeRequirementsHtml(QStringView html) {
+    static const QStringView inlineLabels[] = {
+        u"Processor", u"Memory", u"Graphics", u"DirectX", u"Storage", u"Additional Notes", u"Sound Card", u"Network", u"OS"
+    };
+    QList<RequirementsField> fields;
+    QString line;
+    line.reserve(128);
+    qsizetype labelEnd = -1;
+    qsizetype valueStart = 0;
+
+    auto emitField = [&](qsizetype valueEnd) {
+        const QStringView text(line);
+        const QStringView value = text.mid(valueStart, valueEnd - valueStart).trimmed();
+        if (!value.isEmpty()) {
+            fields.append({labelEnd >= 0 ? text.left(labelEnd).trimmed().toString() : QString(), value.toString()});
+        }
+    };
+    auto endLine = [&]() {
+        emitField(line.size());
+        line.clear();
+        labelEnd = -1;
+        valueStart = 0;
+    };
+    auto colon = [&]() {
+        if (labelEnd < 0) {
+            if (line.size() <= 40 && !QStringView(line).trimmed().isEmpty()) {
+                labelEnd = line.size();
+                valueStart = line.size() + 1;
+            }
+            line.append(u':');
+            return;
+        }
+        for (QStringView label : inlineLabels) {
+            const qsizetype start = line.size() - label.size();
+            if (start <= valueStart || !line.at(start - 1).isSpace()
+                || !QStringView(line).mid(start).startsWith(label, Qt::CaseInsensitive)) continue;
+            emitField(start);
+            line.remove(0, start);
+            labelEnd = line.size();
+            valueStart = line.size() + 1;
+            break;
+        }
+        line.append(u':');
+    };
+
+    const qsizetype size = html.size();
+    for (qsizetype i = 0; i < size; ++i) {
+        const QChar c = html[i];
+        if (c == u'<') {
+            const qsizetype close = html.indexOf(u'>', i + 1);
+            if (close < 0) break;
+            qsizetype name = i + 1;
+            if (name < close && html[name] == u'/') ++name;
+            qsizetype nameEnd = name;
+            while (nameEnd < close && html[nameEnd].isLetterOrNumber()) ++nameEnd;
+            const QStringView tag = html.mid(name, nameEnd - name);
+            static const QStringView breaking[] = {u"br", u"li", u"ul", u"ol", u"p", u"div", u"h1", u"h2", u"h3", u"h4", u"tr"};
+            for (QStringView candidate : breaking) {
+                if (tag.compare(candidate, Qt::CaseInsensitive) == 0) {
+                    endLine();
+                    break;
+                }
+            }
+            i = close;
+        } else if (c == u'&') {
+            // Entities are short; look no further than one could end.
+            const qsizetype semicolon = html.sliced(i + 1, qMin<qsizetype>(10, html.size() - i - 1)).indexOf(u';');
+            const char32_t code = semicolon >= 0 ? decodeHtmlEntity(html.mid(i + 1, semicolon)) : 0;
+            if (code == 0) {
+                line.append(c);
+                continue;
+            }
+            if (code == u':') {
+                colon();
+            } else {
+                const char32_t codes[] = {code};
+                line.append(QString::fromUcs4(codes, 1));
+            }
+            i += semicolon + 1;  // onto the ';'
+        } else if (c == u'\n' || c == u'\r') {
+            endLine();
+        } else if (c == u':') {
+            colon();
+        } else {
+            line.append(c);
+        }
+    }
+    endLine();
+    return fields;
+}
+
+// Maps the labelled fields onto GameRequirements; the first field of each
+// kind wins. With none labelled, the whole block is kept as the CPU.
+inline GameRequirements requirementsFromFields(const QList<RequirementsField>& fields) {
+    GameRequirements requirements;
+    auto is = [](const QString& label, std::initializer_list<QStringView> prefixes) {
+        for (QStringView prefix : prefixes) {
+            if (label.startsWith(prefix, Qt::CaseInsensitive)) return true;
+        }
+        return false;
+    };
+    for (const RequirementsField& field : fields) {
+        QString* target = nullptr;
+        if (is(field.label, {u"Processor", u"CPU"})) target = &requirements.cpu;
+        else if (is(field.label, {u"Graphics", u"Video", u"GPU"})) target = &requirements.gpu;
+        else if (is(field.label, {u"Memory", u"RAM"})) target = &requirements.ram;
+        else if (is(field.label, {u"Storage", u"Hard Drive", u"Hard Disk", u"Disk Space"})) target = &requirements.storage;
+        if (target && target->isEmpty()) *target = field.value;
+    }
+    if (requirements.cpu.isEmpty() && requirements.gpu.isEmpty() && requirements.ram.isEmpty() && requirements.storage.isEmpty()) {
+        QStringList lines;
+        for (const RequirementsField& field : fields) {
+            lines.append(field.label.isEmpty() ? field.value : field.label + ": " + field.value);
+        }
+        requirements.cpu = lines.join('\n');
+    }
+    return requirements;
+}
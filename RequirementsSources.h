@@ -0,0 +1,202 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QStringView>
+#include <QUrl>
+#include <string>
+#include <vector>
+#include "GameRequirements.h"
+#include "JsonPullReader.h"
+#include "RequirementsHtml.h"
+#include "Trace.h"
+
+
+// Endpoints and response parsing for the requirement sources. The base URLs
+// can be pointed at a local server with SYSREQ_STEAM_BASE_URL and
+// SYSREQ_RAWG_BASE_URL.
+
+inline QString steamBaseUrl() {
+    QString url = qEnvironmentVariable("SYSREQ_STEAM_BASE_URL");
+    return url.isEmpty() ? QStringLiteral("https://store.steampowered.com") : url;
+}
+
+inline QString rawgBaseUrl() {
+    QString url = qEnvironmentVariable("SYSREQ_RAWG_BASE_URL");
+    return url.isEmpty() ? QStringLiteral("https://api.rawg.io") : url;
+}
+
+inline QUrl steamAppDetailsUrl(const QString& appId) {
+    return QUrl(QString("%1/api/appdetails?appids=%2&l=english").arg(steamBaseUrl(), appId));
+}
+
+inline QUrl rawgSearchUrl(const QString& gameName) {
+    QString apiKey = qEnvironmentVariable("SYSREQ_RAWG_KEY", "df715f73748447f587032a7708b403b2");
+    return QUrl(QString("%1/api/games?key=%2&search=%3")
+                    .arg(rawgBaseUrl(), apiKey, QString::fromUtf8(QUrl::toPercentEncoding(gameName))));
+}
+
+// How a name search races its sources: RAWG starts immediately and Steam
+// (when the title has a known AppID) after hedgeDelayMs, or as soon as RAWG
+// comes back empty. The first source with requirements wins and the other
+// request is aborted. Each source gets its own transfer timeout.
+struct LookupTimings {
+    int hedgeDelayMs = 200;
+    int rawgTimeoutMs = 10000;
+    int steamTimeoutMs = 10000;
+
+    // SYSREQ_HEDGE_DELAY_MS, SYSREQ_RAWG_TIMEOUT_MS, SYSREQ_STEAM_TIMEOUT_MS.
+    static LookupTimings fromEnvironment() {
+        LookupTimings timings;
+        auto read = [](const char* name, int& value) {
+            bool ok = false;
+            int parsed = qEnvironmentVariableIntValue(name, &ok);
+            if (ok && parsed >= 0) value = parsed;
+        };
+        read("SYSREQ_HEDGE_DELAY_MS", timings.hedgeDelayMs);
+        read("SYSREQ_RAWG_TIMEOUT_MS", timings.rawgTimeoutMs);
+        read("SYSREQ_STEAM_TIMEOUT_MS", timings.steamTimeoutMs);
+        return timings;
+    }
+};
+
+// Known Steam AppIDs for titles RAWG has no PC requirements for.
+inline QString steamAppIdForName(const QString& gameName) {
+    static const QMap<QString, QString> appIdMap = {
+        {"cyberpunk 2077", "1091500"},
+        {"half-life 2", "220"},
+        {"elden ring", "1245620"}
+    };
+    return appIdMap.value(gameName.trimmed().toLower());
+}
+
+// The only paths the parsers below read. Responses are streamed through a
+// JsonPathExtractor with these, so the rest of a page is never held.
+inline const std::vector<std::string>& steamAppDetailsPaths() {
+    static const std::vector<std::string> paths = {
+        "*.success", "*.data.name", "*.data.pc_requirements.minimum", "*.data.pc_requirements.recommended"
+    };
+    return paths;
+}
+
+inline const std::vector<std::string>& rawgSearchPaths() {
+    static const std::vector<std::string> paths = {
+        "results.*.name", "results.*.platforms.*.platform.name",
+        "results.*.platforms.*.requirements.minimum", "results.*.platforms.*.requirements.recommended"
+    };
+    return paths;
+}
+
+// Feeds a response body through a JsonPullReader as it arrives and keeps
+// the matched values as a small document of the same shape. The parsers
+// therefore read a streamed body just as they read a whole one, and the
+// cache stores only what they use.
+class JsonPathExtractor {
+public:
+    explicit JsonPathExtractor(const std::vector<std::string>& paths)
+        : m_reader(paths, [this](const JsonPullReader::Path& path, const JsonPullValue& value) { insert(path, value); }) {}
+    JsonPathExtractor(const JsonPathExtractor&) = delete;
+    JsonPathExtractor& operator=(const JsonPathExtractor&) = delete;
+
+    bool feed(const QByteArray& chunk) { return m_reader.feed(chunk.constData(), std::size_t(chunk.size())); }
+    bool isComplete() const { return m_reader.atEnd(); }
+    QByteArray toJson() const { return QJsonDocument(m_root).toJson(QJsonDocument::Compact); }
+
+private:
+    static QJsonValue withValue(const QJsonValue& node, const JsonPullReader::Path& path, std::size_t depth, const QJsonValue& value) {
+        if (depth == path.size()) return value;
+        const JsonPathComponent& component = path[depth];
+        if (component.isIndex) {
+            QJsonArray array = node.toArray();
+            while (array.size() <= qsizetype(component.index)) array.append(QJsonValue());
+            array[qsizetype(component.index)] = withValue(array.at(qsizetype(component.index)), path, depth + 1, value);
+            return array;
+        }
+        QJsonObject object = node.toObject();
+        const QString key = QString::fromStdString(component.key);
+        object[key] = withValue(object.value(key), path, depth + 1, value);
+        return object;
+    }
+
+    void insert(const JsonPullReader::Path& path, const JsonPullValue& value) {
+        QJsonValue converted;
+        switch (value.type) {
+        case JsonPullValue::Type::Bool: converted = value.boolean; break;
+        case JsonPullValue::Type::Number: converted = value.number; break;
+        case JsonPullValue::Type::String: converted = QString::fromStdString(value.text); break;
+        case JsonPullValue::Type::Null: break;
+        }
+        m_root = withValue(m_root, path, 0, converted).toObject();
+    }
+
+    JsonPullReader m_reader;
+    QJsonObject m_root;
+};
+
+inline GameRequirements notFoundRequirements() {
+    GameRequirements requirements;
+    requirements.cpu = "No requirements found.";
+    return requirements;
+}
+
+inline GameRequirements parseSteamRequirementsHtml(QStringView html) {
+    SYSREQ_TRACE_SCOPE("html extraction");
+    return requirementsFromFields(tokenizeRequirementsHtml(html));
+}
+
+// Steam appdetails response. Returns false if the app or its minimum PC
+// requirements are missing; gameName is set whenever the app is found. A
+// recommended block becomes the "Recommended" tier.
+inline bool parseSteamAppDetails(const QByteArray& payload, const QString& appId, GameRequirements& requirements, QString& gameName) {
+    QJsonObject appObj = QJsonDocument::fromJson(payload).object()[appId].toObject();
+    if (!appObj["success"].toBool()) {
+        return false;
+    }
+    QJsonObject data = appObj["data"].toObject();
+    gameName = data["name"].toString();
+    QJsonObject pcReqs = data["pc_requirements"].toObject();
+    const QString minReq = pcReqs["minimum"].toString();
+    const QString recReq = pcReqs["recommended"].toString();
+    qDebug() << "Steam minimum requirements (HTML):" << minReq;
+    qDebug() << "Steam recommended requirements (HTML):" << recReq;
+    if (minReq.isEmpty()) {
+        return false;
+    }
+    requirements = parseSteamRequirementsHtml(minReq);
+    if (!recReq.isEmpty()) {
+        const GameRequirements recommended = parseSteamRequirementsHtml(recReq);
+        requirements.tiers.append({"Recommended", recommended.cpu, recommended.gpu, recommended.ram, recommended.storage});
+    }
+    return true;
+}
+
+// RAWG search response: the first result with PC minimum requirements.
+inline bool parseRawgSearch(const QByteArray& payload, GameRequirements& requirements) {
+    const QJsonArray results = QJsonDocument::fromJson(payload).object()["results"].toArray();
+    for (const QJsonValue& value : results) {
+        QJsonObject game = value.toObject();
+        qDebug() << "RAWG Game:" << game["name"].toString();
+        const QJsonArray platforms = game["platforms"].toArray();
+        for (const QJsonValue& platVal : platforms) {
+            QJsonObject platObj = platVal.toObject();
+            if (platObj["platform"].toObject()["name"].toString().toLower() != "pc") continue;
+            const QJsonObject platformRequirements = platObj["requirements"].toObject();
+            QString minReq = platformRequirements["minimum"].toString();
+            if (!minReq.isEmpty()) {
+                requirements = GameRequirements();
+                requirements.cpu = minReq;
+                const QString recReq = platformRequirements["recommended"].toString();
+                if (!recReq.isEmpty()) {
+                    requirements.tiers.append({"Recommended", recReq, QString(), QString(), QString()});
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <QtGlobal>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "ComparisonEngine.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REQUIREMENTS_TABLE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+// A requirements catalog stored column by column, for the query "which of
+// these titles does this machine run?". matching() evaluates the same rule
+// as compareProfiles(...).meetsAll() for four titles per step and returns
+// a bitmask with bit i set when title i passes on every component.
+//
+// Columns are padded to a multiple of four with zeros; a zero requirement
+// never passes, and the padding bits are cleared anyway.
+class RequirementsTable {
+public:
+    RequirementsTable() = default;
+    explicit RequirementsTable(const std::vector<RequirementProfile>& profiles) {
+        reserve(profiles.size());
+        for (const RequirementProfile& profile : profiles) append(profile);
+    }
+
+    void reserve(std::size_t count) {
+        for (std::vector<int32_t>* column : columns()) column->reserve(padded(count));
+    }
+
+    void append(const RequirementProfile& profile) {
+        for (std::vector<int32_t>* column : columns()) column->resize(m_size);
+        m_cpuScore.push_back(clampScore(profile.cpuScore));
+        m_cpuRank.push_back(profile.cpuRank);
+        m_gpuScore.push_back(clampScore(profile.gpuScore));
+        m_gpuRank.push_back(profile.gpuRank);
+        m_vramMb.push_back(profile.vramMb);
+        m_ramMb.push_back(profile.ramMb);
+        m_storageMb.push_back(profile.storageMb);
+        ++m_size;
+        for (std::vector<int32_t>* column : columns()) column->resize(padded(m_size), 0);
+    }
+
+    std::size_t size() const { return m_size; }
+
+    static bool isSet(const std::vector<quint64>& mask, std::size_t index) {
+        return (mask[index / 64] >> (index % 64)) & 1;
+    }
+
+    static std::size_t count(const std::vector<quint64>& mask) {
+        std::size_t total = 0;
+        for (quint64 word : mask) {
+            for (; word; word &= word - 1) ++total;
+        }
+        return total;
+    }
+
+    std::vector<quint64> matching(const SystemProfile& system) const {
+        std::vector<quint64> mask((m_size + 63) / 64, 0);
+        if (!system.hasCpu || !system.hasGpu || !system.hasRam || !system.hasStorage) {
+            return mask;
+        }
+#if defined(REQUIREMENTS_TABLE_SSE2)
+        matchSse2(system, mask);
+#else
+        matchScalar(system, mask);
+#endif
+        if (m_size % 64) {
+            mask.back() &= (quint64(1) << (m_size % 64)) - 1;
+        }
+        return mask;
+    }
+
+    // The portable kernel, also the reference for the SSE2 one.
+    void matchScalar(const SystemProfile& system, std::vector<quint64>& mask) const {
+        const int32_t cpuScore = clampScore(system.cpuScore);
+        const int32_t gpuScore = clampScore(system.gpuScore);
+        for (std::size_t i = 0; i < m_size; ++i) {
+            const bool cpu = cpuScore > 0 && m_cpuScore[i] > 0
+                ? cpuScore >= m_cpuScore[i]
+                : system.cpuRank > 0 && m_cpuRank[i] > 0 && system.cpuRank >= m_cpuRank[i];
+            const bool vramKnown = system.vramMb > 0 && m_vramMb[i] > 0;
+            const bool vram = vramKnown && system.vramMb >= m_vramMb[i];
+            bool gpu;
+            if (gpuScore > 0 && m_gpuScore[i] > 0) {
+                gpu = gpuScore >= m_gpuScore[i];
+            } else if (system.gpuRank > 0 && m_gpuRank[i] > 0) {
+                gpu = system.gpuRank > m_gpuRank[i] || (system.gpuRank == m_gpuRank[i] && (!vramKnown || vram));
+            } else {
+                gpu = vram;
+            }
+            const bool ram = system.ramMb > 0 && m_ramMb[i] > 0 && system.ramMb >= m_ramMb[i];
+            const bool storage = system.storageMb > 0 && m_storageMb[i] > 0 && system.storageMb >= m_storageMb[i];
+            if (cpu && gpu && ram && storage) {
+                mask[i / 64] |= quint64(1) << (i % 64);
+            }
+        }
+    }
+
+private:
+    static std::size_t padded(std::size_t count) { return (count + 3) & ~std::size_t(3); }
+
+    // Benchmark scores are far below 2^31; clamping lets every column use
+    // signed 32-bit compares.
+    static int32_t clampScore(quint32 score) {
+        return int32_t(std::min<quint32>(score, quint32(std::numeric_limits<int32_t>::max())));
+    }
+
+    std::vector<std::vector<int32_t>*> columns() {
+        return {&m_cpuScore, &m_cpuRank, &m_gpuScore, &m_gpuRank, &m_vramMb, &m_ramMb, &m_storageMb};
+    }
+
+#if defined(REQUIREMENTS_TABLE_SSE2)
+    void matchSse2(const SystemProfile& system, std::vector<quint64>& mask) const {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ones = _mm_set1_epi32(-1);
+        auto load = [](const std::vector<int32_t>& column, std::size_t i) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(column.data() + i));
+        };
+        // a >= b  <=>  !(b > a)
+        auto greaterEqual = [&](__m128i a, __m128i b) { return _mm_andnot_si128(_mm_cmpgt_epi32(b, a), ones); };
+        auto positive = [&](__m128i a) { return _mm_cmpgt_epi32(a, zero); };
+        auto select = [](__m128i condition, __m128i ifTrue, __m128i ifFalse) {
+            return _mm_or_si128(_mm_and_si128(condition, ifTrue), _mm_andnot_si128(condition, ifFalse));
+        };
+
+        const int32_t cpuScoreValue = clampScore(system.cpuScore);
+        const int32_t gpuScoreValue = clampScore(system.gpuScore);
+        const __m128i cpuScore = _mm_set1_epi32(cpuScoreValue);
+        const __m128i cpuRank = _mm_set1_epi32(system.cpuRank);
+        const __m128i gpuScore = _mm_set1_epi32(gpuScoreValue);
+        const __m128i gpuRank = _mm_set1_epi32(system.gpuRank);
+        const __m128i vramMb = _mm_set1_epi32(system.vramMb);
+        const __m128i ramMb = _mm_set1_epi32(system.ramMb);
+        const __m128i storageMb = _mm_set1_epi32(system.storageMb);
+        const __m128i cpuScored = cpuScoreValue > 0 ? ones : zero;
+        const __m128i gpuScored = gpuScoreValue > 0 ? ones : zero;
+        const __m128i cpuRanked = system.cpuRank > 0 ? ones : zero;
+        const __m128i gpuRanked = system.gpuRank > 0 ? ones : zero;
+        const __m128i vramKnownSystem = system.vramMb > 0 ? ones : zero;
+        const __m128i ramKnown = system.ramMb > 0 ? ones : zero;
+        const __m128i storageKnown = system.storageMb > 0 ? ones : zero;
+
+        for (std::size_t i = 0; i < m_size; i += 4) {
+            const __m128i reqCpuScore = load(m_cpuScore, i);
+            const __m128i reqCpuRank = load(m_cpuRank, i);
+            const __m128i cpuByScore = _mm_and_si128(cpuScored, positive(reqCpuScore));
+            const __m128i cpuByRank = _mm_and_si128(_mm_and_si128(cpuRanked, positive(reqCpuRank)), greaterEqual(cpuRank, reqCpuRank));
+            const __m128i cpu = select(cpuByScore, greaterEqual(cpuScore, reqCpuScore), cpuByRank);
+
+            const __m128i reqVram = load(m_vramMb, i);
+            const __m128i vramKnown = _mm_and_si128(vramKnownSystem, positive(reqVram));
+            const __m128i vram = _mm_and_si128(vramKnown, greaterEqual(vramMb, reqVram));
+            const __m128i reqGpuScore = load(m_gpuScore, i);
+            const __m128i reqGpuRank = load(m_gpuRank, i);
+            const __m128i gpuByScore = _mm_and_si128(gpuScored, positive(reqGpuScore));
+            const __m128i gpuByRank = _mm_and_si128(gpuRanked, positive(reqGpuRank));
+            const __m128i tie = _mm_and_si128(_mm_cmpeq_epi32(gpuRank, reqGpuRank), _mm_or_si128(_mm_andnot_si128(vramKnown, ones), vram));
+            const __m128i rankPass = _mm_or_si128(_mm_cmpgt_epi32(gpuRank, reqGpuRank), tie);
+            const __m128i gpu = select(gpuByScore, greaterEqual(gpuScore, reqGpuScore), select(gpuByRank, rankPass, vram));
+
+            const __m128i reqRam = load(m_ramMb, i);
+            const __m128i ram = _mm_and_si128(_mm_and_si128(ramKnown, positive(reqRam)), greaterEqual(ramMb, reqRam));
+            const __m128i reqStorage = load(m_storageMb, i);
+            const __m128i storage = _mm_and_si128(_mm_and_si128(storageKnown, positive(reqStorage)), greaterEqual(storageMb, reqStorage));
+
+            const __m128i pass = _mm_and_si128(_mm_and_si128(cpu, gpu), _mm_and_si128(ram, storage));
+            const quint64 bits = quint64(_mm_movemask_ps(_mm_castsi128_ps(pass)));
+            mask[i / 64] |= bits << (i % 64);
+        }
+    }
+#endif
+
+    std::size_t m_size = 0;
+    std::vector<int32_t> m_cpuScore;
+    std::vector<int32_t> m_cpuRank;
+    std::vector<int32_t> m_gpuScore;
+    std::vector<int32_t> m_gpuRank;
+    std::vector<int32_t> m_vramMb;
+    std::vector<int32_t> m_ramMb;
+    std::vector<int32_t> m_storageMb;
+};
@@ -0,0 +1 @@
+#include "SteamBatchFetcher.h"
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <QDebug>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include "GameRequirements.h"
+#include "NetworkAccess.h"
+#include "RequirementsCache.h"
+#include "RequirementsSources.h"
+
+
+// Classic token bucket: `capacity` requests may go out back to back, after
+// which they are spaced at `ratePerSecond`.
+class TokenBucket {
+public:
+    TokenBucket(double ratePerSecond, double capacity)
+        : m_rate(ratePerSecond), m_capacity(std::max(1.0, capacity)), m_tokens(m_capacity), m_last(Clock::now()) {}
+
+    bool tryTake() {
+        refill();
+        if (m_tokens < 1.0) return false;
+        m_tokens -= 1.0;
+        return true;
+    }
+
+    // Milliseconds until the next token is available.
+    int msUntilToken() {
+        refill();
+        if (m_tokens >= 1.0 || m_rate <= 0) return 0;
+        return int(std::ceil((1.0 - m_tokens) / m_rate * 1000.0));
+    }
+
+    void drain() { m_tokens = 0; m_last = Clock::now(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void refill() {
+        const Clock::time_point now = Clock::now();
+        m_tokens = std::min(m_capacity, m_tokens + std::chrono::duration<double>(now - m_last).count() * m_rate);
+        m_last = now;
+    }
+
+    double m_rate;
+    double m_capacity;
+    double m_tokens;
+    Clock::time_point m_last;
+};
+
+// Limits for the store API. The public appdetails endpoint allows roughly
+// 200 requests per 5 minutes per client.
+struct SteamFetchLimits {
+    int maxInFlight = 6;
+    double requestsPerSecond = 0.66;
+    int burst = 10;
+    int timeoutMs = 10000;
+
+    // SYSREQ_STEAM_IN_FLIGHT, SYSREQ_STEAM_RATE (requests/s), SYSREQ_STEAM_BURST.
+    static SteamFetchLimits fromEnvironment() {
+        SteamFetchLimits limits;
+        bool ok = false;
+        int inFlight = qEnvironmentVariableIntValue("SYSREQ_STEAM_IN_FLIGHT", &ok);
+        if (ok && inFlight > 0) limits.maxInFlight = inFlight;
+        double rate = qEnvironmentVariable("SYSREQ_STEAM_RATE").toDouble(&ok);
+        if (ok && rate > 0) limits.requestsPerSecond = rate;
+        int burst = qEnvironmentVariableIntValue("SYSREQ_STEAM_BURST", &ok);
+        if (ok && burst > 0) limits.burst = burst;
+        return limits;
+    }
+};
+
+// Refreshes requirements for a list of AppIDs through the thread's shared
+// network manager. At most maxInFlight requests are outstanding and new ones
+// are paced by a token bucket; a 429 pauses the pipeline for Retry-After.
+// Fresh cache entries are answered without a request. Each result is
+// emitted as soon as it arrives, in completion order.
+class SteamBatchFetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SteamBatchFetcher(const SteamFetchLimits &limits = SteamFetchLimits::fromEnvironment(), QObject *parent = nullptr)
+        : QObject(parent), m_limits(limits), m_bucket(limits.requestsPerSecond, limits.burst)
+    {
+        m_pumpTimer.setSingleShot(true);
+        connect(&m_pumpTimer, &QTimer::timeout, this, &SteamBatchFetcher::pump);
+    }
+
+    int pendingCount() const { return int(m_queue.size()) + m_inFlight; }
+
+public slots:
+    void fetch(const QStringList &appIds)
+    {
+        if (m_queue.isEmpty() && m_inFlight == 0) {
+            m_elapsed.start();
+            m_completed = 0;
+            m_requests = 0;
+        }
+        for (const QString &appId : appIds) {
+            m_queue.enqueue(appId.trimmed());
+        }
+        pump();
+    }
+
+signals:
+    void resultReady(const QString &appId, const GameRequirements &requirements, const QString &gameName, bool found);
+    void batchFinished(int completed, int requests, qint64 elapsedMs);
+
+private slots:
+    void pump()
+    {
+        // Nothing goes out, cached or not, until a 429's Retry-After is up.
+        if (!m_pausedUntil.hasExpired()) {
+            m_pumpTimer.start(int(std::max<qint64>(1, m_pausedUntil.remainingTime())));
+            return;
+        }
+        while (!m_queue.isEmpty() && m_inFlight < m_limits.maxInFlight) {
+            const QString appId = m_queue.head();
+            const QString key = RequirementsCache::steamKey(appId);
+            const std::optional<CachedRequirements> cached = RequirementsCache::instance().lookup(key);
+            if (cached && RequirementsCache::instance().isFresh(*cached)) {
+                m_queue.dequeue();
+                complete(appId, *cached);
+                continue;
+            }
+            if (!m_bucket.tryTake()) {
+                m_pumpTimer.start(std::max(1, m_bucket.msUntilToken()));
+                return;
+            }
+            m_queue.dequeue();
+            send(appId, cached);
+        }
+        if (m_queue.isEmpty() && m_inFlight == 0) {
+            emit batchFinished(m_completed, m_requests, m_elapsed.elapsed());
+        }
+    }
+
+private:
+    void send(const QString &appId, const std::optional<CachedRequirements> &cached)
+    {
+        QNetworkRequest request(steamAppDetailsUrl(appId));
+        request.setTransferTimeout(m_limits.timeoutMs);
+        if (cached) {
+            RequirementsCache::addValidators(request, *cached);
+        }
+        ++m_inFlight;
+        ++m_requests;
+        QNetworkReply *reply = sharedNetworkAccessManager()->get(request);
+        auto extractor = std::make_shared<JsonPathExtractor>(steamAppDetailsPaths());
+        connect(reply, &QNetworkReply::readyRead, this, [reply, extractor]() {
+            extractor->feed(reply->readAll());
+        });
+        connect(reply, &QNetworkReply::finished, this, [=]() {
+            reply->deleteLater();
+            --m_inFlight;
+            const QString key = RequirementsCache::steamKey(appId);
+            const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            if (status == 429) {
+                bool ok = false;
+                int retryAfter = reply->rawHeader("Retry-After").toInt(&ok);
+                retryAfter = ok ? std::clamp(retryAfter, 1, 300) : 10;
+                qDebug() << "Steam rate limit hit, pausing for" << retryAfter << "s";
+                m_queue.prepend(appId);
+                m_bucket.drain();
+                m_pausedUntil.setRemainingTime(retryAfter * 1000);
+                m_pumpTimer.start(retryAfter * 1000);
+                return;
+            }
+            if (reply->error() == QNetworkReply::NoError) {
+                extractor->feed(reply->readAll());
+            }
+            if (cached && RequirementsCache::isNotModified(reply)) {
+                RequirementsCache::instance().store(key, *cached);
+                complete(appId, *cached);
+            } else if (reply->error() == QNetworkReply::NoError && extractor->isComplete()) {
+                CachedRequirements entry;
+                entry.payload = extractor->toJson();
+                entry.found = parseSteamAppDetails(entry.payload, appId, entry.requirements, entry.gameName);
+                if (!entry.found) {
+                    entry.requirements = notFoundRequirements();
+                }
+                RequirementsCache::instance().storeReply(key, reply, entry.payload, entry.requirements, entry.gameName, entry.found);
+                complete(appId, entry);
+            } else {
+                // Cut-off and malformed bodies are treated as failures, not cached.
+                qDebug() << "Steam request failed for AppID" << appId << ":"
+                         << (reply->error() == QNetworkReply::NoError ? QStringLiteral("malformed or truncated response") : reply->errorString());
+                complete(appId, cached ? *cached : CachedRequirements{notFoundRequirements()});
+            }
+            if (!m_pumpTimer.isActive()) {
+                pump();
+            }
+        });
+    }
+
+    void complete(const QString &appId, const CachedRequirements &entry)
+    {
+        ++m_completed;
+        emit resultReady(appId, entry.requirements, entry.gameName, entry.found);
+    }
+
+    SteamFetchLimits m_limits;
+    TokenBucket m_bucket;
+    QTimer m_pumpTimer;
+    QDeadlineTimer m_pausedUntil{0};
+    QQueue<QString> m_queue;
+    int m_inFlight = 0;
+    int m_completed = 0;
+    int m_requests = 0;
+    QElapsedTimer m_elapsed;
+};
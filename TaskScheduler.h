@@ -0,0 +1,325 @@
+#pragma once
+
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+inline int defaultWorkerCount()
+{
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 0 ? static_cast<int>(cores) : 1;
+}
+
+// Interactive jobs (a search or a capture the user just asked for) are
+// always taken before background ones (refreshes).
+enum class TaskPriority {
+    Interactive,
+    Background
+};
+
+// Shared flag between whoever started a job and the job itself. Copies
+// refer to the same flag. A cancelled job that has not started is dropped,
+// a running one is expected to check isCancelled() at convenient points,
+// and its continuation never runs.
+class CancellationToken {
+public:
+    CancellationToken() : m_flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { m_flag->store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return m_flag->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+// Runs fn on `thread`, which must be the GUI thread or the scheduler's
+// event thread, unless `context` (an object living there) is destroyed
+// first. Safe to call from any thread: the context is only looked at on its
+// own thread.
+inline void invokeOnContext(const QPointer<QObject>& context, QThread* thread, std::function<void()> fn);
+
+// The result of a job run by TaskScheduler::run(). then() attaches what to
+// do with it on the thread of `context`; it runs once, after the job,
+// unless the job was cancelled or `context` has been destroyed by then.
+template <typename T>
+class TaskFuture {
+public:
+    using Continuation = std::function<void(const T&)>;
+
+    TaskFuture() = default;
+    explicit TaskFuture(const CancellationToken& token) : m_state(std::make_shared<State>()) { m_state->token = token; }
+
+    bool isValid() const { return m_state != nullptr; }
+
+    bool isReady() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->value.has_value();
+    }
+
+    void cancel() const { m_state->token.cancel(); }
+    const CancellationToken& token() const { return m_state->token; }
+
+    // Call it from the thread `context` lives in, the GUI thread or the
+    // scheduler's event thread.
+    void then(QObject* context, Continuation continuation) const {
+        std::unique_lock<std::mutex> lock(m_state->mutex);
+        m_state->context = context;
+        m_state->thread = context->thread();
+        m_state->continuation = std::move(continuation);
+        if (m_state->value) {
+            lock.unlock();
+            dispatch(m_state);
+        }
+    }
+
+    // Called by the worker that ran the job.
+    void setValue(T value) const {
+        std::unique_lock<std::mutex> lock(m_state->mutex);
+        m_state->value = std::move(value);
+        if (m_state->continuation) {
+            lock.unlock();
+            dispatch(m_state);
+        }
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::optional<T> value;
+        CancellationToken token;
+        QPointer<QObject> context;
+        QThread* thread = nullptr;
+        Continuation continuation;
+        bool dispatched = false;
+    };
+
+    static void dispatch(const std::shared_ptr<State>& state) {
+        QPointer<QObject> context;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->dispatched) return;
+            state->dispatched = true;
+            context = state->context;
+        }
+        if (state->token.isCancelled()) return;
+        invokeOnContext(context, state->thread, [state]() {
+            if (!state->token.isCancelled()) {
+                state->continuation(*state->value);
+            }
+        });
+    }
+
+    std::shared_ptr<State> m_state;
+};
+
+// One process-wide pool of worker threads, replacing a QThread per
+// operation. Each worker has its own deques, one per priority; jobs posted
+// from a worker go to its own deque and are taken newest first, jobs posted
+// from elsewhere are spread round-robin, and an idle worker steals the
+// oldest job of a busy one. Blocking jobs (parsing, probing) run here.
+//
+// QObjects that are driven by their own events, like GameRequirementsWorker
+// and its network replies, do not need a worker each: they are moved to
+// eventThread(), a single long-lived thread with an event loop, where any
+// number of them can be in flight at once.
+class TaskScheduler {
+public:
+    using Task = std::function<void()>;
+
+    // SYSREQ_WORKERS, else one worker per core.
+    static TaskScheduler& instance() {
+        static TaskScheduler scheduler([] {
+            bool ok = false;
+            const int workers = qEnvironmentVariableIntValue("SYSREQ_WORKERS", &ok);
+            return ok && workers > 0 ? workers : defaultWorkerCount();
+        }());
+        return scheduler;
+    }
+
+    explicit TaskScheduler(int workers) : m_queues(std::size_t(std::max(1, workers))) {
+        m_workers.reserve(m_queues.size());
+        for (std::size_t i = 0; i < m_queues.size(); ++i) {
+            m_workers.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+
+    ~TaskScheduler() { shutdown(); }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    int workerCount() const { return int(m_queues.size()); }
+
+    // Drops the jobs that have not started, waits for the running ones and
+    // stops the event thread. Call it before the QApplication goes away.
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            if (m_stopping) return;
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& worker : m_workers) {
+            worker.join();
+        }
+        for (Queue& queue : m_queues) {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks[0].clear();
+            queue.tasks[1].clear();
+        }
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        if (m_eventThread) {
+            m_eventThread->quit();
+            m_eventThread->wait();
+            m_eventContext.reset();
+            m_eventThread.reset();
+        }
+    }
+
+    void post(TaskPriority priority, Task task) {
+        std::size_t index = t_workerIndex;
+        if (t_owner != this) {
+            index = m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+        }
+        {
+            Queue& queue = m_queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks[int(priority)].push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            ++m_pending;
+        }
+        m_wake.notify_one();
+    }
+
+    // Runs fn() on a worker and returns its result as a future. fn is
+    // skipped if `token` is cancelled before a worker gets to it.
+    template <typename Fn, typename R = std::invoke_result_t<Fn>>
+    TaskFuture<R> run(TaskPriority priority, const CancellationToken& token, Fn fn) {
+        TaskFuture<R> future(token);
+        post(priority, [future, token, fn = std::move(fn)]() mutable {
+            if (!token.isCancelled()) {
+                future.setValue(fn());
+            }
+        });
+        return future;
+    }
+
+    template <typename Fn, typename R = std::invoke_result_t<Fn>>
+    TaskFuture<R> run(TaskPriority priority, Fn fn) {
+        return run(priority, CancellationToken(), std::move(fn));
+    }
+
+    // Started on first use.
+    QThread* eventThread() {
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        if (!m_eventThread) {
+            m_eventThread = std::make_unique<QThread>();
+            m_eventThread->setObjectName(QStringLiteral("TaskScheduler events"));
+            m_eventContext = std::make_unique<QObject>();
+            m_eventContext->moveToThread(m_eventThread.get());
+            m_eventThread->start();
+        }
+        return m_eventThread.get();
+    }
+
+    // Queues fn on the GUI thread or the event thread. Calls are posted to
+    // an object that lives as long as its thread: the application object,
+    // or one the scheduler keeps on the event thread.
+    bool postToThread(QThread* thread, std::function<void()> fn) {
+        QCoreApplication* app = QCoreApplication::instance();
+        if (app && thread == app->thread()) {
+            return QMetaObject::invokeMethod(app, std::move(fn), Qt::QueuedConnection);
+        }
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        if (!m_eventThread || thread != m_eventThread.get()) {
+            return false;
+        }
+        return QMetaObject::invokeMethod(m_eventContext.get(), std::move(fn), Qt::QueuedConnection);
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks[2];
+    };
+
+    // Own deque first, newest job; then the oldest job of another worker.
+    bool take(std::size_t self, Task& task) {
+        for (int priority = 0; priority < 2; ++priority) {
+            for (std::size_t offset = 0; offset < m_queues.size(); ++offset) {
+                Queue& queue = m_queues[(self + offset) % m_queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                std::deque<Task>& tasks = queue.tasks[priority];
+                if (tasks.empty()) continue;
+                if (offset == 0) {
+                    task = std::move(tasks.back());
+                    tasks.pop_back();
+                } else {
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(std::size_t self) {
+        t_owner = this;
+        t_workerIndex = self;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_sleepMutex);
+                m_wake.wait(lock, [this]() { return m_stopping || m_pending > 0; });
+                if (m_stopping) return;
+                --m_pending;
+            }
+            // Every pending count stands for a queued job. A scan can miss
+            // it while other workers take and post around us, so retry.
+            Task task;
+            while (!take(self, task)) {
+                std::this_thread::yield();
+            }
+            task();
+        }
+    }
+
+    std::vector<Queue> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<std::size_t> m_nextQueue{0};
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::size_t m_pending = 0;
+    bool m_stopping = false;
+
+    std::mutex m_eventMutex;
+    std::unique_ptr<QThread> m_eventThread;
+    std::unique_ptr<QObject> m_eventContext;
+
+    static inline thread_local TaskScheduler* t_owner = nullptr;
+    static inline thread_local std::size_t t_workerIndex = 0;
+};
+
+inline void invokeOnContext(const QPointer<QObject>& context, QThread* thread, std::function<void()> fn) {
+    TaskScheduler::instance().postToThread(thread, [context, fn = std::move(fn)]() {
+        if (context) {
+            fn();
+        }
+    });
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+// Timing spans and counters for the stages of a run: dxdiag launch, report
+// parse, spec extraction, HTTP fetch, HTML extraction, comparison and tree
+// render. Each thread records into its own fixed ring of events, written
+// without locks and overwriting the oldest, and the rings are exported as a
+// Chrome trace (chrome://tracing, Perfetto) when the process exits: to
+// $SYSREQ_TRACE_FILE, else sysreq-trace.json.
+//
+// Off unless built with -DSYSREQ_TRACING=ON. The macros then expand to
+// nothing and the functions below are empty inlines, so call sites cost
+// nothing and need no #ifdef of their own.
+//
+// Names must be string literals; only the pointer is stored.
+//
+// Standard library only, like JsonPullReader.h.
+namespace Trace {
+
+#ifdef SYSREQ_TRACING
+
+struct Timestamp {
+    std::int64_t ns = 0;
+};
+
+inline Timestamp now() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return {std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count()};
+}
+
+struct Event {
+    const char* name = nullptr;
+    std::int64_t begin = 0;
+    std::int64_t duration = 0;  // spans
+    std::int64_t value = 0;     // counters
+    char phase = 'X';           // 'X' span, 'C' counter
+};
+
+// Written by its own thread only. A reader takes what was published before
+// it looked and drops any slot the writer may have reused meanwhile.
+class Ring {
+public:
+    static constexpr std::size_t kCapacity = 8192;
+
+    explicit Ring(int tid) : m_tid(tid), m_events(kCapacity) {}
+
+    int tid() const { return m_tid; }
+
+    void push(const Event& event) {
+        const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+        m_events[head % kCapacity] = event;
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    std::vector<Event> events() const {
+        const std::uint64_t head = m_head.load(std::memory_order_acquire);
+        const std::uint64_t first = head > kCapacity ? head - kCapacity : 0;
+        std::vector<Event> copy;
+        copy.reserve(std::size_t(head - first));
+        for (std::uint64_t i = first; i < head; ++i) {
+            copy.push_back(m_events[i % kCapacity]);
+        }
+        const std::uint64_t after = m_head.load(std::memory_order_acquire);
+        // The writer may already be storing event `after`, into the slot of
+        // event after - kCapacity, so that one cannot be trusted either.
+        const std::uint64_t overwritten = after >= kCapacity ? after - kCapacity + 1 : 0;
+        if (overwritten > first) {
+            copy.erase(copy.begin(), copy.begin() + std::ptrdiff_t(std::min(overwritten, head) - first));
+        }
+        return copy;
+    }
+
+private:
+    const int m_tid;
+    std::vector<Event> m_events;
+    std::atomic<std::uint64_t> m_head{0};
+};
+
+// A thread's ring goes back to the registry when the thread exits and is
+// handed to the next thread that starts, so there are never more rings than
+// threads alive at once, however many short-lived threads come and go. Its
+// events stay in it, so a pool that has been shut down still shows up in
+// the export.
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    std::shared_ptr<Ring> acquire() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_free.empty()) {
+            std::shared_ptr<Ring> ring = std::move(m_free.back());
+            m_free.pop_back();
+            return ring;
+        }
+        m_rings.push_back(std::make_shared<Ring>(int(m_rings.size()) + 1));
+        return m_rings.back();
+    }
+
+    void release(std::shared_ptr<Ring> ring) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(std::move(ring));
+    }
+
+    std::vector<std::shared_ptr<Ring>> rings() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_rings;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<Ring>> m_rings;
+    std::vector<std::shared_ptr<Ring>> m_free;
+};
+
+// The calling thread's hold on its ring, returned when the thread exits.
+class RingLease {
+public:
+    RingLease() : m_ring(Registry::instance().acquire()) {}
+    ~RingLease() { Registry::instance().release(std::move(m_ring)); }
+
+    RingLease(const RingLease&) = delete;
+    RingLease& operator=(const RingLease&) = delete;
+
+    Ring& ring() { return *m_ring; }
+
+private:
+    std::shared_ptr<Ring> m_ring;
+};
+
+inline Ring& threadRing() {
+    thread_local RingLease lease;
+    return lease.ring();
+}
+
+// A span that began at `begin` and ends now, for stages that start and
+// finish in different callbacks.
+inline void complete(const char* name, Timestamp begin) {
+    const Timestamp end = now();
+    threadRing().push({name, begin.ns, end.ns - begin.ns, 0, 'X'});
+}
+
+inline void counter(const char* name, std::int64_t value) {
+    threadRing().push({name, now().ns, 0, value, 'C'});
+}
+
+class Span {
+public:
+    explicit Span(const char* name) : m_name(name), m_begin(now()) {}
+    ~Span() { complete(m_name, m_begin); }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* m_name;
+    Timestamp m_begin;
+};
+
+inline void appendJsonString(std::string& out, const char* text) {
+    out += '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+            out += *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", unsigned(static_cast<unsigned char>(*c)));
+            out += escaped;
+        } else {
+            out += *c;
+        }
+    }
+    out += '"';
+}
+
+// Times are in microseconds, as the format expects. Written a ring at a
+// time, so the export needs no more memory than one ring's events.
+inline bool writeChromeTrace(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fputs("{\"traceEvents\":[", file) >= 0;
+    bool first = true;
+    char number[64];
+    std::string json;
+    for (const std::shared_ptr<Ring>& ring : Registry::instance().rings()) {
+        json.clear();
+        for (const Event& event : ring->events()) {
+            json += first ? "\n{\"name\":" : ",\n{\"name\":";
+            first = false;
+            appendJsonString(json, event.name);
+            std::snprintf(number, sizeof(number), ",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.3f", event.phase, ring->tid(), double(event.begin) / 1000.0);
+            json += number;
+            if (event.phase == 'X') {
+                std::snprintf(number, sizeof(number), ",\"dur\":%.3f}", double(event.duration) / 1000.0);
+            } else {
+                std::snprintf(number, sizeof(number), ",\"args\":{\"value\":%lld}}", static_cast<long long>(event.value));
+            }
+            json += number;
+        }
+        ok = ok && std::fwrite(json.data(), 1, json.size(), file) == json.size();
+    }
+    ok = ok && std::fputs("\n]}\n", file) >= 0;
+    return std::fclose(file) == 0 && ok;
+}
+
+inline void exportFromEnvironment() {
+    const char* path = std::getenv("SYSREQ_TRACE_FILE");
+    const std::string target = path && *path ? path : "sysreq-trace.json";
+    if (!writeChromeTrace(target)) {
+        std::fprintf(stderr, "Could not write trace to %s\n", target.c_str());
+    }
+}
+
+// Call first thing in main(): the handler then runs after the statics
+// created later, the task scheduler's pool among them, are torn down.
+inline void exportAtExit() {
+    Registry::instance();
+    now();
+    std::atexit(exportFromEnvironment);
+}
+
+#define SYSREQ_TRACE_CONCAT_(a, b) a##b
+#define SYSREQ_TRACE_CONCAT(a, b) SYSREQ_TRACE_CONCAT_(a, b)
+#define SYSREQ_TRACE_SCOPE(name) ::Trace::Span SYSREQ_TRACE_CONCAT(sysreqTraceSpan, __LINE__)(name)
+#define SYSREQ_TRACE_COUNTER(name, value) ::Trace::counter(name, std::int64_t(value))
+
+#else
+
+struct Timestamp {};
+
+inline Timestamp now() { return {}; }
+inline void complete(const char*, Timestamp) {}
+inline void exportAtExit() {}
+
+#define SYSREQ_TRACE_SCOPE(name)
+#define SYSREQ_TRACE_COUNTER(name, value)
+
+#endif
+
+}  // namespace Trace
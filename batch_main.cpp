@@ -0,0 +1,851 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QDebug>
+#include <QRegularExpression>
+#include <QBuffer>
+#include <QDirIterator>
+#include <QLoggingCategory>
+#include <QEventLoop>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include "ComparisonEngine.h"
+#include "DxDiagParser.h"
+#include "DxDiagIngest.h"
+#include "GameRequirementsWorker.h"
+#include "SteamBatchFetcher.h"
+#include "GameNameIndex.h"
+#include "FleetIndex.h"
+#include "HardwareProbe.h"
+#include "RequirementsHtml.h"
+#include "RequirementsSources.h"
+#include "RequirementsTable.h"
+#include "Trace.h"
+
+
+// The regex/QMap rank functions the compiled matcher replaced, kept as the
+// reference for --bench-rank.
+static int legacyCpuRank(const QString& cpuStr) {
+    static QMap<QString, int> cpuRanks = {
+        {"i3", 1}, {"i5", 2}, {"i7", 3}, {"i9", 4},
+        {"ryzen 3", 1}, {"ryzen 5", 2}, {"ryzen 7", 3}, {"ryzen 9", 4}
+    };
+    QString s = cpuStr.toLower();
+    for (auto it = cpuRanks.begin(); it != cpuRanks.end(); ++it) {
+        if (s.contains(it.key())) return it.value();
+    }
+    return 0;
+}
+
+static int legacyGpuRank(const QString& gpuStr) {
+    QString s = gpuStr.toLower();
+    static QMap<QString, int> seriesBase = {
+        {"rtx", 1000}, {"gtx", 800}, {"gt", 600},
+        {"rx", 900}, {"r9", 700}, {"r7", 600}, {"r5", 500},
+        {"arc", 850},
+        {"quadro", 700}, {"tesla", 700},
+        {"hd", 200}, {"iris", 300}, {"vega", 400},
+        {"mx", 250},
+        {"uhd", 100}, {"intel hd", 100}, {"intel iris", 200}
+    };
+    int bestRank = 0;
+    for (auto it = seriesBase.begin(); it != seriesBase.end(); ++it) {
+        if (s.contains(it.key())) {
+            QRegularExpression numRe("(\\d{3,4})");
+            QRegularExpressionMatch numMatch = numRe.match(s);
+            int modelNum = numMatch.hasMatch() ? numMatch.captured(1).toInt() : 0;
+            int rank = it.value() + modelNum;
+            if (rank > bestRank) bestRank = rank;
+        }
+    }
+    static QMap<QString, int> gpuRanks = {
+        {"gtx 750", 751}, {"gtx 950", 951}, {"gtx 960", 960}, {"gtx 970", 970}, {"gtx 1050", 1050}, {"gtx 1060", 1060}, {"gtx 1070", 1070}, {"gtx 1080", 1080},
+        {"gtx 1650", 1650}, {"gtx 1660", 1660}, {"rtx 2060", 2060}, {"rtx 2070", 2070}, {"rtx 2080", 2080}, {"rtx 3050", 3050}, {"rtx 3060", 3060}, {"rtx 3070", 3070}, {"rtx 3080", 3080}, {"rtx 4060", 4060}, {"rtx 4070", 4070}, {"rtx 4080", 4080},
+        {"rx 560", 560}, {"rx 570", 570}, {"rx 580", 580}, {"rx 590", 590}, {"rx 5500", 5500}, {"rx 5600", 5600}, {"rx 5700", 5700}, {"rx 6600", 6600}, {"rx 6700", 6700}, {"rx 6800", 6800}, {"rx 6900", 6900},
+        {"arc a380", 1380}, {"arc a750", 1750}, {"arc a770", 1770},
+        {"quadro p2000", 2200}, {"quadro rtx 4000", 4000},
+        {"mx150", 1150}, {"mx250", 1250}, {"mx330", 1330},
+        {"intel hd", 100}, {"intel iris", 200}, {"uhd", 100}
+    };
+    for (auto it = gpuRanks.begin(); it != gpuRanks.end(); ++it) {
+        if (s.contains(it.key())) {
+            if (it.value() > bestRank) bestRank = it.value();
+        }
+    }
+    return bestRank;
+}
+
+// The replace/regex chain the requirements tokenizer replaced, kept as the
+// reference for --bench-html.
+static GameRequirements legacySteamRequirements(QString minReq) {
+    minReq.replace("Processor:", "\nProcessor:");
+    minReq.replace("Memory:", "\nMemory:");
+    minReq.replace("Graphics:", "\nGraphics:");
+    minReq.replace("DirectX:", "\nDirectX:");
+    minReq.replace("Storage:", "\nStorage:");
+    minReq.replace("Additional Notes:", "\nAdditional Notes:");
+
+    static const QRegularExpression cpuRe("Processor:([^\n]*)");
+    static const QRegularExpression ramRe("Memory:([^\n]*)");
+    static const QRegularExpression gpuRe("Graphics:([^\n]*)");
+    static const QRegularExpression storageRe("Storage:([^\n]*)");
+    static const QRegularExpression tagRe("<[^>]*>");
+    auto field = [&minReq](const QRegularExpression& re) {
+        QRegularExpressionMatch match = re.match(minReq);
+        QString value = match.hasMatch() ? match.captured(1).trimmed() : "";
+        value.remove(tagRe);
+        return value;
+    };
+
+    GameRequirements requirements;
+    requirements.cpu = field(cpuRe);
+    requirements.ram = field(ramRe);
+    requirements.gpu = field(gpuRe);
+    requirements.storage = field(storageRe);
+    if (requirements.cpu.isEmpty() && requirements.gpu.isEmpty() && requirements.ram.isEmpty() && requirements.storage.isEmpty()) {
+        requirements.cpu = minReq;
+    }
+    return requirements;
+}
+
+// Collects the pc_requirements blocks (minimum and recommended) from Steam
+// appdetails payloads: raw responses, or requirements cache entries, whose
+// "payload" holds the response. Then times the tokenizer against the legacy
+// chain on them.
+static bool benchmarkHtml(const QStringList& inputs, int repeat, QTextStream& out, QTextStream& err) {
+    QStringList files;
+    for (const QString& input : inputs) {
+        if (QFileInfo(input).isDir()) {
+            QDirIterator it(input, {"*.json"}, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) files.append(it.next());
+        } else {
+            files.append(input);
+        }
+    }
+    QStringList blocks;
+    qint64 totalBytes = 0;
+    for (const QString& path : files) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            err << "Error: Could not open " << path << Qt::endl;
+            continue;
+        }
+        QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+        if (root["payload"].isString()) {
+            root = QJsonDocument::fromJson(root["payload"].toString().toUtf8()).object();
+        }
+        for (const QJsonValue& app : root) {
+            const QJsonObject pcReqs = app.toObject()["data"].toObject()["pc_requirements"].toObject();
+            for (const char* tier : {"minimum", "recommended"}) {
+                const QString html = pcReqs[QLatin1String(tier)].toString();
+                if (html.isEmpty()) continue;
+                blocks.append(html);
+                totalBytes += html.size() * qsizetype(sizeof(QChar));
+            }
+        }
+    }
+    if (blocks.isEmpty()) {
+        err << "Error: No pc_requirements blocks found." << Qt::endl;
+        return false;
+    }
+
+    QElapsedTimer timer;
+    std::vector<GameRequirements> legacy(std::size_t(blocks.size()));
+    timer.start();
+    for (int round = 0; round < repeat; ++round) {
+        for (qsizetype i = 0; i < blocks.size(); ++i) legacy[std::size_t(i)] = legacySteamRequirements(blocks.at(i));
+    }
+    const qint64 legacyNs = qMax<qint64>(1, timer.nsecsElapsed());
+    std::vector<GameRequirements> tokenized(std::size_t(blocks.size()));
+    timer.restart();
+    for (int round = 0; round < repeat; ++round) {
+        for (qsizetype i = 0; i < blocks.size(); ++i) tokenized[std::size_t(i)] = parseSteamRequirementsHtml(blocks.at(i));
+    }
+    const qint64 tokenizedNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    int differing = 0;
+    for (std::size_t i = 0; i < legacy.size(); ++i) {
+        const GameRequirements& a = legacy[i];
+        const GameRequirements& b = tokenized[i];
+        if (a.cpu != b.cpu || a.gpu != b.gpu || a.ram != b.ram || a.storage != b.storage) ++differing;
+    }
+
+    const double parsed = double(blocks.size()) * repeat;
+    auto report = [&](const char* name, qint64 ns) {
+        out << name << QString::number(ns / 1e6, 'f', 2) << " ms (" << QString::number(parsed / (ns / 1e9), 'f', 0) << " blocks/s, "
+            << QString::number(double(totalBytes) * repeat / (ns / 1e9) / (1024 * 1024), 'f', 1) << " MB/s)" << Qt::endl;
+    };
+    out << "Blocks: " << blocks.size() << " from " << files.size() << " files, " << differing
+        << " parsed differently (entities, unlabelled blocks)" << Qt::endl;
+    report("Legacy replace/regex: ", legacyNs);
+    report("Tokenizer: ", tokenizedNs);
+    out << "Speedup: " << QString::number(double(legacyNs) / tokenizedNs, 'f', 1) << "x" << Qt::endl;
+    return true;
+}
+
+// Times the legacy and compiled rank functions over the same model strings
+// and checks that they agree. Returns false on a mismatch.
+static bool benchmarkRanks(const QStringList& models, QTextStream& out) {
+    if (models.isEmpty()) {
+        out << "No CPU/GPU strings to benchmark." << Qt::endl;
+        return true;
+    }
+    for (const QString& model : models) {
+        if (legacyCpuRank(model) != cpuRank(model) || legacyGpuRank(model) != gpuRank(model)) {
+            out << "Rank mismatch for: " << model << Qt::endl;
+            return false;
+        }
+    }
+
+    const int rounds = qMax(1, 200000 / int(models.size()));
+    qint64 checksum = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < rounds; ++round) {
+        for (const QString& model : models) {
+            checksum += legacyCpuRank(model) + legacyGpuRank(model);
+        }
+    }
+    const qint64 legacyNs = qMax<qint64>(1, timer.nsecsElapsed());
+    timer.restart();
+    for (int round = 0; round < rounds; ++round) {
+        for (const QString& model : models) {
+            checksum -= cpuRank(model) + gpuRank(model);
+        }
+    }
+    const qint64 compiledNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    const double calls = double(rounds) * models.size();
+    out << "Rank lookups: " << qint64(calls) << " x (cpu + gpu), checksum " << checksum << Qt::endl;
+    out << "  regex/QMap: " << QString::number(legacyNs / calls, 'f', 1) << " ns/string" << Qt::endl;
+    out << "  compiled:   " << QString::number(compiledNs / calls, 'f', 1) << " ns/string" << Qt::endl;
+    out << "  speedup:    " << QString::number(double(legacyNs) / compiledNs, 'f', 1) << "x" << Qt::endl;
+    return true;
+}
+
+// Parses each dxdiag /x or /t capture `repeat` times from memory on the
+// thread pool and reports throughput, so disk speed does not skew the
+// numbers.
+static bool benchmarkParse(const QStringList& inputs, int threads, int repeat, QTextStream& out, QTextStream& err) {
+    const QStringList files = findDxDiagCaptures(inputs);
+    QList<QByteArray> captures;
+    QList<DxDiagCaptureFormat> formats;
+    qint64 totalBytes = 0;
+    for (const QString& path : files) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            err << "Error: Could not open " << path << Qt::endl;
+            return false;
+        }
+        QByteArray capture = file.readAll();
+        const DxDiagCaptureFormat format = detectDxDiagFormat(capture.left(64));
+        if (format == DxDiagCaptureFormat::Text && isDxDiagUtf16(capture.constData(), capture.size())) {
+            capture = dxdiagUtf16ToUtf8(capture);
+        }
+        totalBytes += capture.size();
+        captures.append(capture);
+        formats.append(format);
+    }
+    if (captures.isEmpty()) {
+        err << "Error: No dxdiag captures found." << Qt::endl;
+        return false;
+    }
+
+    std::atomic<qint64> itemCount{0};
+    std::atomic<bool> failed{false};
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < repeat; ++round) {
+        parallelFor(std::size_t(captures.size()), threads, [&](std::size_t begin, std::size_t end) {
+            qint64 items = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                DxDiagReport::Builder builder;
+                QString errorMessage;
+                bool ok = false;
+                if (formats.at(qsizetype(i)) == DxDiagCaptureFormat::Text) {
+                    const QByteArray& capture = captures.at(qsizetype(i));
+                    ok = parseDxDiagText(capture.constData(), std::size_t(capture.size()), builder, errorMessage);
+                } else {
+                    QBuffer buffer;
+                    buffer.setData(captures.at(qsizetype(i)));
+                    buffer.open(QIODevice::ReadOnly);
+                    ok = parseDxDiagXml(&buffer, builder, errorMessage);
+                }
+                if (!ok) {
+                    qWarning() << files.at(qsizetype(i)) << ":" << errorMessage;
+                    failed = true;
+                }
+                const DxDiagReport report = builder.build();
+                for (int section = 0; section < report.sectionCount(); ++section) items += report.itemCount(section);
+            }
+            itemCount += items;
+        });
+    }
+    const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+    if (failed) {
+        return false;
+    }
+    const double reports = double(captures.size()) * repeat;
+    const double bytesPerSecond = double(totalBytes) * repeat / (elapsedNs / 1e9);
+    out << "Parsed " << qint64(reports) << " reports (" << itemCount.load() << " fields) on " << threads << " threads in "
+        << QString::number(elapsedNs / 1e6, 'f', 2) << " ms" << Qt::endl;
+    out << "  " << QString::number(reports / (elapsedNs / 1e9), 'f', 0) << " reports/s, "
+        << QString::number(bytesPerSecond / (1024.0 * 1024.0), 'f', 1) << " MB/s ("
+        << QString::number(bytesPerSecond / 1e9, 'f', 2) << " GB/s)" << Qt::endl;
+
+    // What the GUI waits for before the first verdict: the section index
+    // plus SystemInformation and DisplayDevices, parsed on demand.
+    timer.restart();
+    for (int round = 0; round < repeat; ++round) {
+        parallelFor(std::size_t(captures.size()), threads, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                DxDiagLazyReport report;
+                QString errorMessage;
+                if (!report.openData(captures.at(qsizetype(i)), errorMessage)
+                    || !report.section(u"SystemInformation") || !report.section(u"DisplayDevices")) {
+                    failed = true;
+                }
+            }
+        });
+    }
+    const qint64 lazyNs = qMax<qint64>(1, timer.nsecsElapsed());
+    out << "  on demand (index + SystemInformation + DisplayDevices): "
+        << QString::number(lazyNs / 1e3 / reports, 'f', 1) << " us/report, "
+        << QString::number(double(elapsedNs) / lazyNs, 'f', 1) << "x faster than a full parse" << Qt::endl;
+    return !failed;
+}
+
+// Parses every capture under the given files/directories on the thread pool
+// and reports reports/s. With --out, writes the extracted specs as TSV.
+static bool ingestCaptures(const QStringList& inputs, int threads, int repeat, const QString& outPath,
+                           QTextStream& out, QTextStream& err) {
+    const QStringList captures = findDxDiagCaptures(inputs);
+    if (captures.isEmpty()) {
+        err << "Error: No dxdiag captures found." << Qt::endl;
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<IngestedReport> reports;
+    for (int round = 0; round < repeat; ++round) {
+        reports = ingestDxDiagCaptures(captures, threads);
+    }
+    const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    int failed = 0;
+    for (const IngestedReport& report : reports) {
+        if (!report.ok()) {
+            ++failed;
+            err << report.path << ": " << report.error << Qt::endl;
+        }
+    }
+    const double parsed = double(reports.size()) * repeat;
+    out << "Ingested " << qint64(parsed) << " reports (" << failed << " failed) on " << threads << " threads in "
+        << QString::number(elapsedNs / 1e6, 'f', 2) << " ms ("
+        << QString::number(parsed / (elapsedNs / 1e9), 'f', 0) << " reports/s)" << Qt::endl;
+
+    if (!outPath.isEmpty()) {
+        QFile file(outPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            err << "Error: Could not open " << file.fileName() << Qt::endl;
+            return false;
+        }
+        QTextStream tsv(&file);
+        tsv << "path\tcpu\tgpu\tram\tstorage\n";
+        for (const IngestedReport& report : reports) {
+            if (!report.ok()) continue;
+            const QMap<QString, QString> specs = extractSystemSpecs(report.parsed);
+            tsv << report.path << '\t' << specs.value("CPU") << '\t' << specs.value("GPU") << '\t' << specs.value("RAM")
+                << '\t' << specs.value("StorageDisplay") << '\n';
+        }
+    }
+    return failed == 0;
+}
+
+// Runs the GUI's requirements lookup for each title (a name, or a Steam
+// AppID if numeric) and reports which source answered and how fast. Point
+// SYSREQ_*_BASE_URL at a mock server to measure hedging under injected
+// latency, and set SYSREQ_CACHE_TTL=0 to bypass fresh cache entries.
+static bool benchmarkLookup(const QStringList& titles, int repeat, QTextStream& out) {
+    QList<qint64> latencies;
+    for (int round = 0; round < repeat; ++round) {
+        for (const QString& title : titles) {
+            static const QRegularExpression digits("^\\d+$");
+            const bool isAppId = digits.match(title).hasMatch();
+            GameRequirementsWorker worker(isAppId ? QString() : title, isAppId ? title : QString());
+            QString source;
+            qint64 elapsedMs = 0;
+            QObject::connect(&worker, &GameRequirementsWorker::lookupResolved, [&](const QString& by, qint64 ms) {
+                source = by.isEmpty() ? QStringLiteral("none") : by;
+                elapsedMs = ms;
+            });
+            QEventLoop loop;
+            QObject::connect(&worker, &GameRequirementsWorker::finished, &loop, &QEventLoop::quit);
+            QTimer::singleShot(0, &worker, &GameRequirementsWorker::processRequirementsSearch);
+            loop.exec();
+            out << title << '\t' << source << '\t' << elapsedMs << " ms" << Qt::endl;
+            latencies.append(elapsedMs);
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    qint64 total = 0;
+    for (qint64 latency : latencies) total += latency;
+    out << "Lookups: " << latencies.size() << ", mean " << QString::number(double(total) / latencies.size(), 'f', 1)
+        << " ms, p50 " << latencies.at(latencies.size() / 2) << " ms, max " << latencies.last() << " ms" << Qt::endl;
+    return true;
+}
+
+// Refreshes Steam requirements for a list of AppIDs (arguments, or files
+// with one AppID per line) through the batch pipeline, printing each result
+// as it arrives.
+static bool fetchSteamBatch(const QStringList& inputs, QTextStream& out, QTextStream& err) {
+    QStringList appIds;
+    for (const QString& input : inputs) {
+        QFile file(input);
+        if (!file.exists()) {
+            appIds.append(input);
+            continue;
+        }
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            err << "Error: Could not open " << input << Qt::endl;
+            return false;
+        }
+        while (!file.atEnd()) {
+            const QString line = QString::fromUtf8(file.readLine()).trimmed();
+            if (!line.isEmpty() && !line.startsWith('#')) appIds.append(line);
+        }
+    }
+
+    SteamBatchFetcher fetcher;
+    int found = 0;
+    QObject::connect(&fetcher, &SteamBatchFetcher::resultReady,
+                     [&](const QString& appId, const GameRequirements& requirements, const QString& gameName, bool ok) {
+        if (ok) ++found;
+        out << appId << '\t' << gameName << '\t' << requirements.cpu << '\t' << requirements.gpu << '\t'
+            << requirements.ram << '\t' << requirements.storage << Qt::endl;
+    });
+    QEventLoop loop;
+    QObject::connect(&fetcher, &SteamBatchFetcher::batchFinished, [&](int completed, int requests, qint64 elapsedMs) {
+        out << "Fetched " << completed << " AppIDs (" << found << " with requirements, " << requests << " requests) in "
+            << elapsedMs << " ms (" << QString::number(completed / (qMax<qint64>(1, elapsedMs) / 1000.0), 'f', 1)
+            << " AppIDs/s)" << Qt::endl;
+        loop.quit();
+    });
+    QTimer::singleShot(0, &fetcher, [&]() { fetcher.fetch(appIds); });
+    loop.exec();
+    return true;
+}
+
+// Looks titles up in the local app-list index and reports the matches and
+// the time per search.
+static bool findGames(const QStringList& queries, int repeat, QTextStream& out, QTextStream& err) {
+    QElapsedTimer timer;
+    timer.start();
+    const GameNameIndex& index = GameNameIndex::instance();
+    if (index.isEmpty()) {
+        err << "Error: No Steam app list at " << GameNameIndex::defaultPath() << " (set SYSREQ_APPLIST)" << Qt::endl;
+        return false;
+    }
+    out << "Indexed " << index.size() << " titles in " << timer.elapsed() << " ms" << Qt::endl;
+
+    for (const QString& query : queries) {
+        out << query << ":" << Qt::endl;
+        for (const GameNameIndex::Match& match : index.search(query)) {
+            out << "  " << match.appId << '\t' << match.name;
+            if (match.distance > 0) out << "  (" << match.distance << " edits)";
+            out << Qt::endl;
+        }
+    }
+
+    qsizetype results = 0;
+    timer.restart();
+    for (int round = 0; round < repeat; ++round) {
+        for (const QString& query : queries) results += index.search(query).size();
+    }
+    const double searches = double(queries.size()) * repeat;
+    out << "Searches: " << qint64(searches) << ", " << QString::number(timer.nsecsElapsed() / 1e3 / searches, 'f', 1)
+        << " us/search (" << results << " results)" << Qt::endl;
+    return true;
+}
+
+
+static bool readJsonFile(const QString& path, QJsonDocument& doc, QString& errorMessage) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorMessage = "Could not open " + path;
+        return false;
+    }
+    QJsonParseError parseError;
+    doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        errorMessage = path + ": " + parseError.errorString();
+        return false;
+    }
+    return true;
+}
+
+static QMap<QString, QString> loadSystemSpecs(const QJsonObject& obj) {
+    QMap<QString, QString> specs;
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+        specs[it.key()] = it.value().toString();
+    }
+    return specs;
+}
+
+static QList<GameRequirements> loadCatalog(const QJsonArray& array, QStringList& names) {
+    QList<GameRequirements> catalog;
+    catalog.reserve(array.size());
+    names.reserve(array.size());
+    for (const QJsonValue& value : array) {
+        QJsonObject obj = value.toObject();
+        GameRequirements requirements;
+        requirements.cpu = obj["cpu"].toString();
+        requirements.gpu = obj["gpu"].toString();
+        requirements.ram = obj["ram"].toString();
+        requirements.storage = obj["storage"].toString();
+        auto readTier = [](const QString& name, const QJsonObject& tier) {
+            return RequirementTier{tier["name"].toString(name), tier["cpu"].toString(), tier["gpu"].toString(),
+                                   tier["ram"].toString(), tier["storage"].toString()};
+        };
+        if (obj["recommended"].isObject()) {
+            requirements.tiers.append(readTier("Recommended", obj["recommended"].toObject()));
+        }
+        for (const QJsonValue& tier : obj["tiers"].toArray()) {
+            requirements.tiers.append(readTier("Tier " + QString::number(requirements.tiers.size() + 1), tier.toObject()));
+        }
+        catalog.append(requirements);
+        names.append(obj["name"].toString());
+    }
+    return catalog;
+}
+
+// Collects this machine's specs with the first hardware probe that works
+// and prints them with the time taken.
+static bool probeHardware(int repeat, QTextStream& out, QTextStream& err) {
+    for (const std::unique_ptr<HardwareProbe>& probe : createHardwareProbes()) {
+        HardwareProbeResult result;
+        QString errorMessage;
+        QElapsedTimer timer;
+        timer.start();
+        bool ok = true;
+        for (int round = 0; round < repeat && ok; ++round) {
+            result = HardwareProbeResult();
+            ok = probe->probe(result, errorMessage);
+        }
+        const qint64 elapsedNs = timer.nsecsElapsed();
+        if (!ok) {
+            err << probe->name() << ": " << errorMessage << Qt::endl;
+            continue;
+        }
+        if (!result.captureFile.isEmpty() && !loadDxDiagCapture(result.captureFile, result.report, errorMessage)) {
+            err << probe->name() << ": " << errorMessage << Qt::endl;
+            continue;
+        }
+        const QMap<QString, QString> specs = extractSystemSpecs(result.report);
+        for (auto it = specs.begin(); it != specs.end(); ++it) {
+            out << it.key() << ": " << it.value() << Qt::endl;
+        }
+        out << "Probed with " << probe->name() << " in " << QString::number(elapsedNs / 1e6 / repeat, 'f', 2) << " ms" << Qt::endl;
+        return true;
+    }
+    return false;
+}
+
+// Loads every capture under the given files/directories into a fleet index
+// and lists, per catalog title, the machines that meet it. With --out,
+// writes one title/machine pair per line.
+static bool queryFleet(const QStringList& inputs, const QString& catalogPath, int threads, int repeat, const QString& outPath,
+                       QTextStream& out, QTextStream& err) {
+    QJsonDocument catalogDoc;
+    QString errorMessage;
+    if (!readJsonFile(catalogPath, catalogDoc, errorMessage)) {
+        err << "Error: " << errorMessage << Qt::endl;
+        return false;
+    }
+    QStringList names;
+    const QList<GameRequirements> catalog = loadCatalog(catalogDoc.array(), names);
+
+    QElapsedTimer timer;
+    timer.start();
+    FleetIndex fleet;
+    const FleetIndex::LoadResult loaded = fleet.loadCaptures(inputs, threads);
+    const qint64 loadNs = timer.nsecsElapsed();
+    for (const QString& error : loaded.errors) {
+        err << error << Qt::endl;
+    }
+    if (fleet.size() == 0) {
+        err << "Error: No machines loaded." << Qt::endl;
+        return false;
+    }
+    out << "Loaded " << fleet.size() << " machines (" << loaded.errors.size() << " failed) in "
+        << QString::number(loadNs / 1e6, 'f', 2) << " ms" << Qt::endl;
+
+    const std::vector<RequirementProfile> profiles = buildRequirementProfiles(catalog, threads);
+    std::vector<std::vector<int>> matches(profiles.size());
+    timer.restart();
+    for (int round = 0; round < repeat; ++round) {
+        for (std::size_t i = 0; i < profiles.size(); ++i) {
+            matches[i] = fleet.machinesMeeting(profiles[i]);
+        }
+    }
+    const qint64 queryNs = qMax<qint64>(1, timer.nsecsElapsed());
+    for (std::size_t i = 0; i < matches.size(); ++i) {
+        out << names.at(qsizetype(i)) << '\t' << matches[i].size() << " machines" << Qt::endl;
+    }
+    const double queries = double(profiles.size()) * repeat;
+    out << "Answered " << qint64(queries) << " queries in " << QString::number(queryNs / 1e6, 'f', 2) << " ms ("
+        << QString::number(queryNs / 1e6 / qMax(1.0, queries), 'f', 3) << " ms/query)" << Qt::endl;
+
+    if (!outPath.isEmpty()) {
+        QFile file(outPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            err << "Error: Could not open " << file.fileName() << Qt::endl;
+            return false;
+        }
+        QTextStream tsv(&file);
+        tsv << "name\tmachine\n";
+        for (std::size_t i = 0; i < matches.size(); ++i) {
+            for (int machine : matches[i]) {
+                tsv << names.at(qsizetype(i)) << '\t' << fleet.id(machine) << '\n';
+            }
+        }
+    }
+    return true;
+}
+
+// Times the columnar "meets spec" filter against scoreBatch on one thread,
+// with the catalog repeated up to `titles` records, and checks that both
+// pick the same titles.
+static bool benchmarkFilter(const SystemProfile& system, const std::vector<RequirementProfile>& catalog, int titles, int repeat,
+                            QTextStream& out, QTextStream& err) {
+    if (catalog.empty()) {
+        err << "Error: Empty catalog" << Qt::endl;
+        return false;
+    }
+    std::vector<RequirementProfile> profiles;
+    profiles.reserve(std::size_t(qMax<qsizetype>(titles, qsizetype(catalog.size()))));
+    while (profiles.size() < std::size_t(titles) || profiles.size() < catalog.size()) {
+        profiles.insert(profiles.end(), catalog.begin(), catalog.end());
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const RequirementsTable table(profiles);
+    const qint64 buildNs = timer.nsecsElapsed();
+
+    std::vector<ComparisonResult> results;
+    timer.restart();
+    for (int i = 0; i < repeat; ++i) {
+        results = scoreBatch(system, profiles, 1);
+    }
+    const qint64 scalarNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    std::vector<quint64> mask;
+    timer.restart();
+    for (int i = 0; i < repeat; ++i) {
+        mask = table.matching(system);
+    }
+    const qint64 filterNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        if (results[i].meetsAll() != RequirementsTable::isSet(mask, i)) ++mismatches;
+    }
+
+    out << "Titles: " << profiles.size() << ", meets all: " << RequirementsTable::count(mask)
+        << ", mismatches: " << mismatches << Qt::endl;
+    out << "Built columns in " << QString::number(buildNs / 1e6, 'f', 2) << " ms" << Qt::endl;
+    out << "scoreBatch: " << QString::number(scalarNs / 1e6 / repeat, 'f', 3) << " ms per pass" << Qt::endl;
+    out << "Columnar filter: " << QString::number(filterNs / 1e6 / repeat, 'f', 3) << " ms per pass ("
+        << QString::number(double(scalarNs) / filterNs, 'f', 1) << "x)" << Qt::endl;
+    return mismatches == 0;
+}
+
+int main(int argc, char *argv[]) {
+    Trace::exportAtExit();
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("dxdiag_batch_cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Scores a catalog of game requirements against one system spec.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("specs", "JSON object with CPU, GPU, RAM and Storage keys.");
+    parser.addPositionalArgument("catalog", "JSON array of {name, cpu, gpu, ram, storage} records.");
+    QCommandLineOption threadsOption("threads", "Worker threads (default: all cores).", "n", QString::number(defaultWorkerCount()));
+    QCommandLineOption repeatOption("repeat", "Score the catalog n times, for throughput measurements.", "n", "1");
+    QCommandLineOption outOption("out", "Write per-title verdicts as TSV to file.", "file");
+    QCommandLineOption benchRankOption("bench-rank", "Benchmark compiled vs regex rank matching on the input strings.");
+    QCommandLineOption benchParseOption("bench-parse", "Benchmark the dxdiag parsers; positional arguments are /x or /t captures or directories.");
+    QCommandLineOption lookupOption("lookup", "Time requirement lookups; positional arguments are game names or Steam AppIDs.");
+    QCommandLineOption fetchSteamOption("fetch-steam", "Refresh Steam requirements; positional arguments are AppIDs or files of AppIDs.");
+    QCommandLineOption findGameOption("find-game", "Search the local Steam app list; positional arguments are queries.");
+    QCommandLineOption probeOption("probe", "Collect this machine's specs with the native hardware probe (dxdiag.exe as fallback).");
+    QCommandLineOption benchFilterOption("bench-filter", "Benchmark the columnar meets-spec filter against scoreBatch.");
+    QCommandLineOption titlesOption("titles", "Repeat the catalog up to n titles for --bench-filter.", "n", "100000");
+    QCommandLineOption fleetOption("fleet", "List the machines that meet each title in the catalog file; positional arguments are dxdiag captures or directories.", "catalog");
+    QCommandLineOption benchHtmlOption("bench-html", "Benchmark the pc_requirements tokenizer; positional arguments are Steam appdetails payloads, cache entries or directories.");
+    QCommandLineOption ingestOption("ingest", "Parse dxdiag /x and /t captures; positional arguments are files or directories.");
+    parser.addOption(threadsOption);
+    parser.addOption(repeatOption);
+    parser.addOption(outOption);
+    parser.addOption(benchRankOption);
+    parser.addOption(benchParseOption);
+    parser.addOption(benchFilterOption);
+    parser.addOption(benchHtmlOption);
+    parser.addOption(titlesOption);
+    parser.addOption(ingestOption);
+    parser.addOption(fleetOption);
+    parser.addOption(lookupOption);
+    parser.addOption(fetchSteamOption);
+    parser.addOption(findGameOption);
+    parser.addOption(probeOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const QStringList args = parser.positionalArguments();
+    if (parser.isSet(benchParseOption)) {
+        if (args.isEmpty()) {
+            parser.showHelp(1);
+        }
+        QLoggingCategory::setFilterRules("default.debug=false");
+        return benchmarkParse(args, qMax(1, parser.value(threadsOption).toInt()), qMax(1, parser.value(repeatOption).toInt()),
+                              out, err) ? 0 : 1;
+    }
+    if (parser.isSet(benchHtmlOption)) {
+        if (args.isEmpty()) {
+            parser.showHelp(1);
+        }
+        QLoggingCategory::setFilterRules("default.debug=false");
+        return benchmarkHtml(args, qMax(1, parser.value(repeatOption).toInt()), out, err) ? 0 : 1;
+    }
+    if (parser.isSet(probeOption)) {
+        QLoggingCategory::setFilterRules("default.debug=false");
+        return probeHardware(qMax(1, parser.value(repeatOption).toInt()), out, err) ? 0 : 1;
+    }
+    if (parser.isSet(findGameOption)) {
+        if (args.isEmpty()) {
+            parser.showHelp(1);
+        }
+        QLoggingCategory::setFilterRules("default.debug=false");
+        return findGames(args, qMax(1, parser.value(repeatOption).toInt()), out, err) ? 0 : 1;
+    }
+    if (parser.isSet(fetchSteamOption)) {
+        if (args.isEmpty()) {
+            parser.showHelp(1);
+        }
+        QLoggingCategory::setFilterRules("default.debug=false");
+        return fetchSteamBatch(args, out, err) ? 0 : 1;
+    }
+    if (parser.isSet(lookupOption)) {
+        if (args.isEmpty()) {
+            parser.showHelp(1);
+        }
+        QLoggingCategory::setFilterRules("default.debug=false");
+        return benchmarkLookup(args, qMax(1, parser.value(repeatOption).toInt()), out) ? 0 : 1;
+    }
+    if (parser.isSet(ingestOption)) {
+        if (args.isEmpty()) {
+            parser.showHelp(1);
+        }
+        QLoggingCategory::setFilterRules("default.debug=false");
+        return ingestCaptures(args, qMax(1, parser.value(threadsOption).toInt()), qMax(1, parser.value(repeatOption).toInt()),
+                              parser.value(outOption), out, err) ? 0 : 1;
+    }
+    if (parser.isSet(fleetOption)) {
+        if (args.isEmpty()) {
+            parser.showHelp(1);
+        }
+        QLoggingCategory::setFilterRules("default.debug=false");
+        return queryFleet(args, parser.value(fleetOption), qMax(1, parser.value(threadsOption).toInt()),
+                          qMax(1, parser.value(repeatOption).toInt()), parser.value(outOption), out, err) ? 0 : 1;
+    }
+    if (args.size() != 2) {
+        parser.showHelp(1);
+    }
+
+    QJsonDocument specsDoc, catalogDoc;
+    QString errorMessage;
+    if (!readJsonFile(args.at(0), specsDoc, errorMessage) || !readJsonFile(args.at(1), catalogDoc, errorMessage)) {
+        err << "Error: " << errorMessage << Qt::endl;
+        return 1;
+    }
+
+    QStringList names;
+    const QList<GameRequirements> catalog = loadCatalog(catalogDoc.array(), names);
+    const QMap<QString, QString> specs = loadSystemSpecs(specsDoc.object());
+
+    if (parser.isSet(benchRankOption)) {
+        QStringList models = {specs.value("CPU"), specs.value("GPU")};
+        for (const GameRequirements& requirements : catalog) {
+            models << requirements.cpu << requirements.gpu;
+        }
+        models.removeAll(QString());
+        return benchmarkRanks(models, out) ? 0 : 1;
+    }
+
+    const int threads = qMax(1, parser.value(threadsOption).toInt());
+    const int repeat = qMax(1, parser.value(repeatOption).toInt());
+
+    if (parser.isSet(benchFilterOption)) {
+        return benchmarkFilter(buildSystemProfile(specs), buildRequirementProfiles(catalog, threads),
+                               qMax(1, parser.value(titlesOption).toInt()), repeat, out, err) ? 0 : 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const SystemProfile system = buildSystemProfile(specs);
+    const std::vector<TieredRequirementProfile> profiles = buildTieredRequirementProfiles(catalog, threads);
+    const qint64 normalizeNs = timer.nsecsElapsed();
+    timer.restart();
+    std::vector<TieredComparison> results;
+    for (int i = 0; i < repeat; ++i) {
+        results = scoreTiersBatch(system, profiles, threads);
+    }
+    const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    int meetsAll = 0, failing = 0;
+    QMap<QString, int> highestTiers;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const ComparisonResult& minimum = results[i].tiers[0];
+        if (minimum.meetsAll()) ++meetsAll;
+        else if (minimum.anyFailing()) ++failing;
+        if (results[i].highestMet > 0) ++highestTiers[requirementTierName(catalog.at(qsizetype(i)), results[i].highestMet)];
+    }
+
+    const double comparisons = double(catalog.size()) * repeat;
+    out << "Titles: " << catalog.size() << ", meets all: " << meetsAll << ", may not meet: " << failing
+        << ", undetermined: " << (catalog.size() - meetsAll - failing) << Qt::endl;
+    for (auto it = highestTiers.constBegin(); it != highestTiers.constEnd(); ++it) {
+        out << "Highest tier met " << it.key() << ": " << it.value() << Qt::endl;
+    }
+    out << "Normalized " << catalog.size() << " requirement records in " << QString::number(normalizeNs / 1e6, 'f', 2) << " ms" << Qt::endl;
+    out << "Scored " << qint64(comparisons) << " comparisons on " << threads << " threads in "
+        << QString::number(elapsedNs / 1e6, 'f', 2) << " ms ("
+        << QString::number(comparisons / (elapsedNs / 1e9), 'f', 0) << " comparisons/s)" << Qt::endl;
+
+    if (parser.isSet(outOption)) {
+        QFile file(parser.value(outOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            err << "Error: Could not open " << file.fileName() << Qt::endl;
+            return 1;
+        }
+        QTextStream tsv(&file);
+        tsv << "name\tcpu\tgpu\tram\tstorage\thighest_tier\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const ComparisonResult& result = results[i].tiers[0];
+            tsv << names.at(qsizetype(i)) << '\t' << verdictText(result.cpu, "CPU") << '\t' << verdictText(result.gpu, "GPU")
+                << '\t' << verdictText(result.ram, "RAM") << '\t' << verdictText(result.storage, "Storage")
+                << '\t' << requirementTierName(catalog.at(qsizetype(i)), results[i].highestMet) << '\n';
+        }
+    }
+
+    return 0;
+}
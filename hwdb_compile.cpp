@@ -0,0 +1,142 @@
+// Build-time tool: compiles hardware_db.csv into the memory-mappable
+// hardware.db read by HardwareDatabase.h.
+//
+//   hwdb_compile <input.csv> <output.db>
+//
+// CSV columns: kind (cpu|gpu), vendor (intel|amd|nvidia), name, score, vram_mb.
+// Lines starting with '#' and the header line are ignored.
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "HardwareDatabaseFormat.h"
+
+
+struct SourceRow {
+    HwdbKind kind;
+    HwdbVendor vendor;
+    std::string key;
+    std::string name;
+    uint32_t score;
+    uint32_t vramMb;
+};
+
+static std::vector<std::string> splitCsvLine(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, ',')) {
+        std::size_t first = field.find_first_not_of(" \t\r");
+        std::size_t last = field.find_last_not_of(" \t\r");
+        fields.push_back(first == std::string::npos ? std::string() : field.substr(first, last - first + 1));
+    }
+    return fields;
+}
+
+static HwdbVendor parseVendor(const std::string& vendor) {
+    if (vendor == "intel") return HwdbVendor::Intel;
+    if (vendor == "amd") return HwdbVendor::Amd;
+    if (vendor == "nvidia") return HwdbVendor::Nvidia;
+    return HwdbVendor::Unknown;
+}
+
+static std::vector<SourceRow> readSource(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open " + path);
+    }
+    std::vector<SourceRow> rows;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#' || line.rfind("kind,", 0) == 0) continue;
+        std::vector<std::string> fields = splitCsvLine(line);
+        if (fields.size() < 5) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": expected 5 columns");
+        }
+        SourceRow row;
+        if (fields[0] == "cpu") row.kind = HwdbKind::Cpu;
+        else if (fields[0] == "gpu") row.kind = HwdbKind::Gpu;
+        else throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": unknown kind " + fields[0]);
+        row.vendor = parseVendor(fields[1]);
+        row.name = fields[2];
+        row.score = static_cast<uint32_t>(std::strtoul(fields[3].c_str(), nullptr, 10));
+        row.vramMb = static_cast<uint32_t>(std::strtoul(fields[4].c_str(), nullptr, 10));
+
+        char key[HwdbMaxKeyLength];
+        std::size_t keyLength = hwdbNormalize(row.name.data(), row.name.size(), key);
+        if (keyLength == 0) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": name normalizes to an empty key");
+        }
+        row.key.assign(key, keyLength);
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: hwdb_compile <input.csv> <output.db>\n";
+        return 2;
+    }
+
+    try {
+        std::vector<SourceRow> rows = readSource(argv[1]);
+        std::sort(rows.begin(), rows.end(), [](const SourceRow& a, const SourceRow& b) {
+            return a.kind != b.kind ? a.kind < b.kind : a.key < b.key;
+        });
+        for (std::size_t i = 1; i < rows.size(); ++i) {
+            if (rows[i].kind == rows[i - 1].kind && rows[i].key == rows[i - 1].key) {
+                throw std::runtime_error("Duplicate key \"" + rows[i].key + "\" (" + rows[i - 1].name + ", " + rows[i].name + ")");
+            }
+        }
+
+        std::string pool;
+        std::vector<HwdbRecord> records;
+        records.reserve(rows.size());
+        for (const SourceRow& row : rows) {
+            HwdbRecord record = {};
+            record.keyOffset = static_cast<uint32_t>(pool.size());
+            record.keyLength = static_cast<uint16_t>(row.key.size());
+            pool += row.key;
+            record.nameOffset = static_cast<uint32_t>(pool.size());
+            record.nameLength = static_cast<uint16_t>(row.name.size());
+            pool += row.name;
+            record.kind = static_cast<uint8_t>(row.kind);
+            record.vendor = static_cast<uint8_t>(row.vendor);
+            record.score = row.score;
+            record.vramMb = row.vramMb;
+            records.push_back(record);
+        }
+
+        HwdbHeader header = {};
+        std::copy(std::begin(HwdbMagic), std::end(HwdbMagic), header.magic);
+        header.version = HwdbVersion;
+        header.recordCount = static_cast<uint32_t>(records.size());
+        header.recordsOffset = sizeof(HwdbHeader);
+        header.stringPoolOffset = static_cast<uint32_t>(sizeof(HwdbHeader) + records.size() * sizeof(HwdbRecord));
+        header.stringPoolSize = static_cast<uint32_t>(pool.size());
+
+        std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error(std::string("Could not open ") + argv[2] + " for writing");
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), std::streamsize(records.size() * sizeof(HwdbRecord)));
+        out.write(pool.data(), std::streamsize(pool.size()));
+        if (!out) {
+            throw std::runtime_error(std::string("Failed writing ") + argv[2]);
+        }
+        std::cout << "hwdb_compile: " << records.size() << " records, " << pool.size() << " bytes of strings -> " << argv[2] << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "hwdb_compile: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
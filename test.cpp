@@ -1,26 +1,19 @@
 #include "dxtextmake.h"
+#include "DxDiagTextScanner.h"
 #include <thread>
 #include <chrono>
+#include <sstream>
 
 using namespace std;
 int main() {
     this_thread::sleep_for(chrono::seconds(2));
     dxdiag();
-    fstream file;
-    string filename="dxdiag_output.txt";
-    file.open(filename.c_str());
-    string pro_name;
-    string line;
-    int linereach = 223;
-    int linelim = 0;
-
-    while (getline(file, line) && linelim < linereach) {
-        linelim++;
-        cout << line << "\n" ;
-    };
-
-    file.close();
-
-   
-    }
+    ifstream file("dxdiag_output.txt", ios::binary);
+    stringstream contents;
+    contents << file.rdbuf();
+    const string report = contents.str();
 
+    dxdiagScanText(report.data(), report.size(),
+        [](string_view title) { cout << "[" << title << "]\n"; },
+        [](string_view key, string_view value) { cout << "    " << key << " = " << value << "\n"; });
+}
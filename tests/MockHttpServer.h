@@ -0,0 +1,162 @@
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+
+// A local stand-in for the Steam and RAWG endpoints. It speaks just enough
+// HTTP/1.1 for QNetworkAccessManager: one GET per connection, answered by
+// the test's handler (optionally after a delay) and then closed. It records
+// every request, the most requests open at once, and the requests whose
+// client hung up before the answer was sent.
+class MockHttpServer {
+public:
+    struct Request {
+        QByteArray method;
+        QByteArray target;                      // path and query
+        QHash<QByteArray, QByteArray> headers;  // names lowercased
+        qint64 receivedMs = 0;                  // since listen()
+    };
+
+    struct Response {
+        int status = 200;
+        QByteArray body;
+        QList<QPair<QByteArray, QByteArray>> headers;
+        int delayMs = 0;
+    };
+
+    using Handler = std::function<Response(const Request&)>;
+
+    MockHttpServer() {
+        QObject::connect(&m_server, &QTcpServer::newConnection, &m_server, [this]() {
+            while (QTcpSocket* socket = m_server.nextPendingConnection()) {
+                accept(socket);
+            }
+        });
+    }
+
+    bool listen() {
+        m_clock.start();
+        return m_server.listen(QHostAddress::LocalHost);
+    }
+
+    QString url() const { return QStringLiteral("http://127.0.0.1:%1").arg(m_server.serverPort()); }
+    qint64 elapsedMs() const { return m_clock.elapsed(); }
+
+    void setHandler(Handler handler) { m_handler = std::move(handler); }
+
+    void reset() {
+        m_requests.clear();
+        m_aborted.clear();
+        m_maxOpen = 0;
+    }
+
+    const QList<Request>& requests() const { return m_requests; }
+
+    QList<Request> requestsTo(const QByteArray& prefix) const {
+        QList<Request> matching;
+        for (const Request& request : m_requests) {
+            if (request.target.startsWith(prefix)) matching.append(request);
+        }
+        return matching;
+    }
+
+    const QList<QByteArray>& aborted() const { return m_aborted; }
+    int maxOpen() const { return m_maxOpen; }
+
+private:
+    struct Connection {
+        QByteArray buffer;
+        QByteArray target;
+        bool received = false;
+        bool answered = false;
+    };
+
+    void accept(QTcpSocket* socket) {
+        auto connection = std::make_shared<Connection>();
+        QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket, connection]() {
+            connection->buffer += socket->readAll();
+            if (connection->received) return;
+            const qsizetype end = connection->buffer.indexOf("\r\n\r\n");
+            if (end < 0) return;
+            connection->received = true;
+
+            Request request;
+            request.receivedMs = m_clock.elapsed();
+            const QList<QByteArray> lines = connection->buffer.left(end).split('\n');
+            const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+            request.method = requestLine.value(0);
+            request.target = requestLine.value(1);
+            for (qsizetype i = 1; i < lines.size(); ++i) {
+                const qsizetype colon = lines.at(i).indexOf(':');
+                if (colon > 0) {
+                    request.headers.insert(lines.at(i).left(colon).trimmed().toLower(), lines.at(i).mid(colon + 1).trimmed());
+                }
+            }
+            connection->target = request.target;
+            m_requests.append(request);
+            m_maxOpen = std::max(m_maxOpen, ++m_open);
+
+            const Response response = m_handler ? m_handler(request) : Response{404, QByteArray(), {}, 0};
+            auto send = [this, socket, connection, response]() {
+                if (connection->answered) return;
+                connection->answered = true;
+                --m_open;
+                socket->write(serialize(response));
+                socket->disconnectFromHost();
+            };
+            if (response.delayMs > 0) {
+                QTimer::singleShot(response.delayMs, socket, send);
+            } else {
+                send();
+            }
+        });
+        QObject::connect(socket, &QTcpSocket::disconnected, socket, [this, socket, connection]() {
+            if (connection->received && !connection->answered) {
+                connection->answered = true;
+                --m_open;
+                m_aborted.append(connection->target);
+            }
+            socket->deleteLater();
+        });
+    }
+
+    static QByteArray serialize(const Response& response) {
+        QByteArray reason = "Status";
+        switch (response.status) {
+        case 200: reason = "OK"; break;
+        case 304: reason = "Not Modified"; break;
+        case 404: reason = "Not Found"; break;
+        case 429: reason = "Too Many Requests"; break;
+        case 503: reason = "Service Unavailable"; break;
+        }
+        QByteArray out = "HTTP/1.1 " + QByteArray::number(response.status) + ' ' + reason + "\r\n";
+        for (const auto& header : response.headers) {
+            out += header.first + ": " + header.second + "\r\n";
+        }
+        out += "Content-Type: application/json\r\n";
+        out += "Content-Length: " + QByteArray::number(response.body.size()) + "\r\n";
+        out += "Connection: close\r\n\r\n";
+        return out + response.body;
+    }
+
+    QTcpServer m_server;
+    QElapsedTimer m_clock;
+    Handler m_handler;
+    QList<Request> m_requests;
+    QList<QByteArray> m_aborted;
+    int m_open = 0;
+    int m_maxOpen = 0;
+};
@@ -0,0 +1,56 @@
+#include <QtTest>
+#include "RequirementsHtml.h"
+
+
+// The pc_requirements tokenizer on hand-written blocks: labels, inline
+// labels and entities, which Steam uses freely inside values.
+class RequirementsHtmlTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void labelledListItems()
+    {
+        const QList<RequirementsField> fields = tokenizeRequirementsHtml(
+            u"<strong>Minimum:</strong><br><ul class=\"bb_ul\"><li><strong>Processor:</strong> i5-4460<br></li>"
+            u"<li><strong>Memory:</strong> 8 GB RAM<br></li></ul>");
+        QCOMPARE(fields.size(), 2);
+        QCOMPARE(fields.at(0).label, QStringLiteral("Processor"));
+        QCOMPARE(fields.at(0).value, QStringLiteral("i5-4460"));
+        QCOMPARE(fields.at(1).label, QStringLiteral("Memory"));
+        QCOMPARE(fields.at(1).value, QStringLiteral("8 GB RAM"));
+    }
+
+    // An entity well past the start of the block used to send the scan
+    // back to the start of its lookahead window, forever.
+    void entityAfterLabel()
+    {
+        const QList<RequirementsField> fields = tokenizeRequirementsHtml(
+            u"<li><strong>Processor:</strong> i5 &amp; up</li><li>Graphics: GeForce&reg; GTX 970 &quot;or better&quot;</li>");
+        QCOMPARE(fields.size(), 2);
+        QCOMPARE(fields.at(0).label, QStringLiteral("Processor"));
+        QCOMPARE(fields.at(0).value, QStringLiteral("i5 & up"));
+        QCOMPARE(fields.at(1).label, QStringLiteral("Graphics"));
+        QCOMPARE(fields.at(1).value, QString(u"GeForce® GTX 970 \"or better\""));
+    }
+
+    void unknownEntityIsKept()
+    {
+        const QList<RequirementsField> fields = tokenizeRequirementsHtml(u"Storage: 50 GB &bogus; &amp free");
+        QCOMPARE(fields.size(), 1);
+        QCOMPARE(fields.at(0).value, QStringLiteral("50 GB &bogus; &amp free"));
+    }
+
+    void encodedColonStartsInlineField()
+    {
+        const QList<RequirementsField> fields = tokenizeRequirementsHtml(u"OS&#58; Windows 10 64-bit Memory&#x3A; 8 GB");
+        QCOMPARE(fields.size(), 2);
+        QCOMPARE(fields.at(0).label, QStringLiteral("OS"));
+        QCOMPARE(fields.at(0).value, QStringLiteral("Windows 10 64-bit"));
+        QCOMPARE(fields.at(1).label, QStringLiteral("Memory"));
+        QCOMPARE(fields.at(1).value, QStringLiteral("8 GB"));
+    }
+};
+
+QTEST_APPLESS_MAIN(RequirementsHtmlTest)
+#include "tst_requirementshtml.moc"
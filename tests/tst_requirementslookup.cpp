@@ -0,0 +1,394 @@
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <memory>
+#include "GameRequirementsWorker.h"
+#include "MockHttpServer.h"
+#include "RequirementsCache.h"
+#include "SteamBatchFetcher.h"
+
+
+// Requirement lookups against a local stand-in for Steam and RAWG: the
+// cache's fresh hits, revalidation and fallbacks, and how a name search
+// races the two sources under injected latency, and how the batch fetcher
+// paces Steam.
+class RequirementsLookupTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    struct Search {
+        std::unique_ptr<GameRequirementsWorker> worker;
+        bool finished = false;
+        bool resolved = false;
+        QString source;
+        qint64 elapsedMs = -1;
+        GameRequirements requirements;
+    };
+
+    std::unique_ptr<Search> startSearch(const QString &gameName, const QString &appId, const LookupTimings &timings = LookupTimings())
+    {
+        auto search = std::make_unique<Search>();
+        Search *state = search.get();
+        search->worker = std::make_unique<GameRequirementsWorker>(gameName, appId);
+        search->worker->setTimings(timings);
+        connect(state->worker.get(), &GameRequirementsWorker::lookupResolved, state->worker.get(), [state](const QString &source, qint64 elapsedMs) {
+            state->source = source;
+            state->elapsedMs = elapsedMs;
+        });
+        connect(state->worker.get(), &GameRequirementsWorker::searchFinished, state->worker.get(), [state](const GameRequirements &requirements) {
+            state->resolved = true;
+            state->requirements = requirements;
+        });
+        connect(state->worker.get(), &GameRequirementsWorker::finished, state->worker.get(), [state]() { state->finished = true; });
+        search->worker->processRequirementsSearch();
+        return search;
+    }
+
+    static QByteArray steamBody(const QString &appId, const QString &name, const QString &cpu)
+    {
+        const QString minimum = "<strong>Minimum:</strong><br><ul class=\"bb_ul\"><li><strong>Processor:</strong> " + cpu + "<br></li></ul>";
+        const QJsonObject data{{"name", name}, {"pc_requirements", QJsonObject{{"minimum", minimum}}}};
+        return QJsonDocument(QJsonObject{{appId, QJsonObject{{"success", true}, {"data", data}}}}).toJson(QJsonDocument::Compact);
+    }
+
+    static QByteArray steamNotFoundBody(const QString &appId)
+    {
+        return QJsonDocument(QJsonObject{{appId, QJsonObject{{"success", false}}}}).toJson(QJsonDocument::Compact);
+    }
+
+    static QByteArray rawgBody(const QString &name, const QString &minimum)
+    {
+        const QJsonObject platform{{"platform", QJsonObject{{"name", "PC"}}}, {"requirements", QJsonObject{{"minimum", minimum}}}};
+        const QJsonObject game{{"name", name}, {"platforms", QJsonArray{platform}}};
+        return QJsonDocument(QJsonObject{{"results", QJsonArray{game}}}).toJson(QJsonDocument::Compact);
+    }
+
+    // A title with a known Steam AppID, so a name search races both sources.
+    static QString racedTitle() { return QStringLiteral("Cyberpunk 2077"); }
+    static QString racedAppId() { return steamAppIdForName(racedTitle()); }
+
+    // RAWG and Steam answer with requirements after the given delays
+    // (an empty RAWG result with rawgFound false).
+    void serveBoth(int rawgDelayMs, int steamDelayMs, bool rawgFound = true)
+    {
+        const QString appId = racedAppId();
+        m_server.setHandler([=](const MockHttpServer::Request &request) {
+            if (request.target.startsWith("/api/games")) {
+                const QByteArray body = rawgFound ? rawgBody(racedTitle(), "RAWG CPU") : QByteArray("{\"results\":[]}");
+                return MockHttpServer::Response{200, body, {}, rawgDelayMs};
+            }
+            return MockHttpServer::Response{200, steamBody(appId, racedTitle(), "Steam CPU"), {}, steamDelayMs};
+        });
+    }
+
+    static LookupTimings timings(int hedgeDelayMs, int rawgTimeoutMs = 10000, int steamTimeoutMs = 10000)
+    {
+        LookupTimings timings;
+        timings.hedgeDelayMs = hedgeDelayMs;
+        timings.rawgTimeoutMs = rawgTimeoutMs;
+        timings.steamTimeoutMs = steamTimeoutMs;
+        return timings;
+    }
+
+    struct Batch {
+        std::unique_ptr<SteamBatchFetcher> fetcher;
+        QStringList results;
+        int finishedCount = 0;
+        int requests = 0;
+    };
+
+    static std::unique_ptr<Batch> startBatch(const SteamFetchLimits &limits)
+    {
+        auto batch = std::make_unique<Batch>();
+        Batch *state = batch.get();
+        batch->fetcher = std::make_unique<SteamBatchFetcher>(limits);
+        connect(state->fetcher.get(), &SteamBatchFetcher::resultReady, state->fetcher.get(),
+                [state](const QString &appId, const GameRequirements &, const QString &, bool) { state->results.append(appId); });
+        connect(state->fetcher.get(), &SteamBatchFetcher::batchFinished, state->fetcher.get(), [state](int, int requests, qint64) {
+            ++state->finishedCount;
+            state->requests = requests;
+        });
+        return batch;
+    }
+
+    static SteamFetchLimits limits(int maxInFlight)
+    {
+        SteamFetchLimits limits;
+        limits.maxInFlight = maxInFlight;
+        limits.requestsPerSecond = 1000;
+        limits.burst = 100;
+        limits.timeoutMs = 5000;
+        return limits;
+    }
+
+    // The AppID in an appdetails request target.
+    static QString appIdOf(const QByteArray &target)
+    {
+        const qsizetype begin = target.indexOf("appids=") + 7;
+        return QString::fromUtf8(target.mid(begin, target.indexOf('&', begin) - begin));
+    }
+
+    static QByteArray steamPath(const QString &appId) { return "/api/appdetails?appids=" + appId.toUtf8(); }
+
+    static void seed(const QString &key, const QString &cpu, const QDateTime &fetchedAt, const QByteArray &etag = QByteArray(),
+                     const QByteArray &lastModified = QByteArray())
+    {
+        CachedRequirements entry;
+        entry.requirements.cpu = cpu;
+        entry.found = true;
+        entry.etag = etag;
+        entry.lastModified = lastModified;
+        RequirementsCache::instance().store(key, entry, fetchedAt);
+    }
+
+    static QDateTime stale() { return QDateTime::currentDateTimeUtc().addDays(-30); }
+
+    QTemporaryDir m_dir;
+    MockHttpServer m_server;
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+        QVERIFY(m_server.listen());
+        // Read on first use, so before anything touches the cache or index.
+        qputenv("SYSREQ_CACHE_DIR", QFile::encodeName(m_dir.path() + "/cache"));
+        qputenv("SYSREQ_CACHE_TTL", "3600");
+        qputenv("SYSREQ_APPLIST", QFile::encodeName(m_dir.path() + "/no_applist.json"));
+        qputenv("SYSREQ_STEAM_BASE_URL", m_server.url().toUtf8());
+        qputenv("SYSREQ_RAWG_BASE_URL", m_server.url().toUtf8());
+    }
+
+    void init()
+    {
+        RequirementsCache::instance().clear();
+        m_server.reset();
+        m_server.setHandler(nullptr);
+    }
+
+    void freshHitMakesNoRequest()
+    {
+        seed(RequirementsCache::steamKey("1001"), "Cached CPU", QDateTime::currentDateTimeUtc());
+
+        auto search = startSearch(QString(), "1001");
+        QTRY_VERIFY_WITH_TIMEOUT(search->finished, 5000);
+        QVERIFY(search->resolved);
+        QCOMPARE(search->requirements.cpu, QStringLiteral("Cached CPU"));
+        QTest::qWait(50);
+        QCOMPARE(m_server.requests().size(), 0);
+    }
+
+    void staleEntryIsRevalidated()
+    {
+        const QByteArray etag = "\"v1\"";
+        const QByteArray lastModified = "Wed, 21 Oct 2015 07:28:00 GMT";
+        const QString key = RequirementsCache::steamKey("1002");
+        seed(key, "Cached CPU", stale(), etag, lastModified);
+        m_server.setHandler([](const MockHttpServer::Request &) { return MockHttpServer::Response{304, QByteArray(), {}, 0}; });
+
+        auto search = startSearch(QString(), "1002");
+        QTRY_VERIFY_WITH_TIMEOUT(search->finished, 5000);
+        QCOMPARE(search->requirements.cpu, QStringLiteral("Cached CPU"));
+
+        const QList<MockHttpServer::Request> requests = m_server.requestsTo(steamPath("1002"));
+        QCOMPARE(requests.size(), 1);
+        QCOMPARE(requests.first().headers.value("if-none-match"), etag);
+        QCOMPARE(requests.first().headers.value("if-modified-since"), lastModified);
+
+        // The 304 renewed the entry: the next search is a fresh hit.
+        const std::optional<CachedRequirements> renewed = RequirementsCache::instance().lookup(key);
+        QVERIFY(renewed);
+        QVERIFY(RequirementsCache::instance().isFresh(*renewed));
+        QCOMPARE(renewed->etag, etag);
+        auto again = startSearch(QString(), "1002");
+        QTRY_VERIFY_WITH_TIMEOUT(again->finished, 5000);
+        QCOMPARE(m_server.requestsTo(steamPath("1002")).size(), 1);
+    }
+
+    void changedEntryIsReplaced()
+    {
+        const QString key = RequirementsCache::steamKey("1003");
+        seed(key, "Old CPU", stale(), "\"v1\"");
+        m_server.setHandler([](const MockHttpServer::Request &) {
+            return MockHttpServer::Response{200, steamBody("1003", "Game 1003", "New CPU"), {{"ETag", "\"v2\""}}, 0};
+        });
+
+        auto search = startSearch(QString(), "1003");
+        QTRY_VERIFY_WITH_TIMEOUT(search->finished, 5000);
+        QCOMPARE(search->requirements.cpu, QStringLiteral("New CPU"));
+        const std::optional<CachedRequirements> entry = RequirementsCache::instance().lookup(key);
+        QVERIFY(entry);
+        QCOMPARE(entry->etag, QByteArray("\"v2\""));
+        QCOMPARE(entry->requirements.cpu, QStringLiteral("New CPU"));
+    }
+
+    void failedRequestFallsBackToStaleEntry()
+    {
+        seed(RequirementsCache::steamKey("1004"), "Stale CPU", stale(), "\"v1\"");
+        m_server.setHandler([](const MockHttpServer::Request &) { return MockHttpServer::Response{503, "busy", {}, 0}; });
+
+        auto search = startSearch(QString(), "1004");
+        QTRY_VERIFY_WITH_TIMEOUT(search->finished, 5000);
+        QCOMPARE(m_server.requestsTo(steamPath("1004")).size(), 1);
+        QVERIFY(search->resolved);
+        QCOMPARE(search->requirements.cpu, QStringLiteral("Stale CPU"));
+    }
+
+    void negativeEntryIsCached()
+    {
+        const QString key = RequirementsCache::steamKey("1005");
+        m_server.setHandler([](const MockHttpServer::Request &) {
+            return MockHttpServer::Response{200, steamNotFoundBody("1005"), {}, 0};
+        });
+
+        auto search = startSearch(QString(), "1005");
+        QTRY_VERIFY_WITH_TIMEOUT(search->finished, 5000);
+        QCOMPARE(search->requirements.cpu, notFoundRequirements().cpu);
+        const std::optional<CachedRequirements> entry = RequirementsCache::instance().lookup(key);
+        QVERIFY(entry);
+        QVERIFY(!entry->found);
+
+        auto again = startSearch(QString(), "1005");
+        QTRY_VERIFY_WITH_TIMEOUT(again->finished, 5000);
+        QCOMPARE(again->requirements.cpu, notFoundRequirements().cpu);
+        QCOMPARE(m_server.requestsTo(steamPath("1005")).size(), 1);
+    }
+
+    // A 200 whose body is cut off is a failure, not a negative answer.
+    void truncatedReplyIsNotCached()
+    {
+        const QString staleKey = RequirementsCache::steamKey("1006");
+        seed(staleKey, "Stale CPU", stale(), "\"v1\"");
+        m_server.setHandler([](const MockHttpServer::Request &request) {
+            const QString appId = appIdOf(request.target);
+            return MockHttpServer::Response{200, steamBody(appId, "Game " + appId, "New CPU").left(40), {}, 0};
+        });
+
+        auto search = startSearch(QString(), "1006");
+        QTRY_VERIFY_WITH_TIMEOUT(search->finished, 5000);
+        QCOMPARE(search->requirements.cpu, QStringLiteral("Stale CPU"));
+        const std::optional<CachedRequirements> entry = RequirementsCache::instance().lookup(staleKey);
+        QVERIFY(entry);
+        QVERIFY(!RequirementsCache::instance().isFresh(*entry));
+        QCOMPARE(entry->requirements.cpu, QStringLiteral("Stale CPU"));
+
+        auto uncached = startSearch(QString(), "1007");
+        QTRY_VERIFY_WITH_TIMEOUT(uncached->finished, 5000);
+        QVERIFY(!RequirementsCache::instance().lookup(RequirementsCache::steamKey("1007")));
+
+        auto batch = startBatch(limits(2));
+        batch->fetcher->fetch({"1008"});
+        QTRY_COMPARE_WITH_TIMEOUT(batch->finishedCount, 1, 5000);
+        QCOMPARE(batch->results, QStringList{"1008"});
+        QVERIFY(!RequirementsCache::instance().lookup(RequirementsCache::steamKey("1008")));
+    }
+
+    void steamStartsAfterHedgeDelay()
+    {
+        QVERIFY(!racedAppId().isEmpty());
+        serveBoth(3000, 0);
+
+        auto search = startSearch(racedTitle(), QString(), timings(150));
+        QTRY_VERIFY_WITH_TIMEOUT(search->finished, 5000);
+        QCOMPARE(search->source, QStringLiteral("Steam"));
+        QCOMPARE(search->requirements.cpu, QStringLiteral("Steam CPU"));
+        QVERIFY2(search->elapsedMs < 3000, qPrintable(QString::number(search->elapsedMs)));
+
+        const QList<MockHttpServer::Request> rawg = m_server.requestsTo("/api/games");
+        const QList<MockHttpServer::Request> steam = m_server.requestsTo(steamPath(racedAppId()));
+        QCOMPARE(rawg.size(), 1);
+        QCOMPARE(steam.size(), 1);
+        QVERIFY2(steam.first().receivedMs - rawg.first().receivedMs >= 120,
+                 qPrintable(QString::number(steam.first().receivedMs - rawg.first().receivedMs)));
+
+        // The slow RAWG request lost and was aborted, not waited out.
+        QTRY_COMPARE_WITH_TIMEOUT(m_server.aborted().size(), 1, 2000);
+        QVERIFY(m_server.aborted().first().startsWith("/api/games"));
+    }
+
+    void firstSourceWithinHedgeDelayWins()
+    {
+        serveBoth(0, 0);
+
+        auto search = startSearch(racedTitle(), QString(), timings(500));
+        QTRY_VERIFY_WITH_TIMEOUT(search->finished, 5000);
+        QCOMPARE(search->source, QStringLiteral("RAWG"));
+        QCOMPARE(search->requirements.cpu, QStringLiteral("RAWG CPU"));
+        QTest::qWait(700);
+        QCOMPARE(m_server.requestsTo("/api/appdetails").size(), 0);
+    }
+
+    void emptyRawgResultStartsSteamAtOnce()
+    {
+        serveBoth(0, 0, false);
+
+        auto search = startSearch(racedTitle(), QString(), timings(5000));
+        QTRY_VERIFY_WITH_TIMEOUT(search->finished, 3000);
+        QCOMPARE(search->source, QStringLiteral("Steam"));
+        QVERIFY2(search->elapsedMs < 2000, qPrintable(QString::number(search->elapsedMs)));
+    }
+
+    void sourceTimeoutFallsThroughToSteam()
+    {
+        serveBoth(5000, 0);
+
+        auto search = startSearch(racedTitle(), QString(), timings(10000, 300));
+        QTRY_VERIFY_WITH_TIMEOUT(search->finished, 4000);
+        QCOMPARE(search->source, QStringLiteral("Steam"));
+        QVERIFY2(search->elapsedMs >= 250 && search->elapsedMs < 3000, qPrintable(QString::number(search->elapsedMs)));
+        QTRY_COMPARE_WITH_TIMEOUT(m_server.aborted().size(), 1, 2000);
+        QVERIFY(m_server.aborted().first().startsWith("/api/games"));
+    }
+
+    void batchKeepsToInFlightCap()
+    {
+        m_server.setHandler([](const MockHttpServer::Request &request) {
+            const QString appId = appIdOf(request.target);
+            return MockHttpServer::Response{200, steamBody(appId, "Game " + appId, "CPU " + appId), {}, 150};
+        });
+
+        auto batch = startBatch(limits(2));
+        batch->fetcher->fetch({"2001", "2002", "2003", "2004", "2005", "2006"});
+        QTRY_COMPARE_WITH_TIMEOUT(batch->finishedCount, 1, 5000);
+        QCOMPARE(batch->results.size(), 6);
+        QCOMPARE(batch->requests, 6);
+        QCOMPARE(m_server.requests().size(), 6);
+        QCOMPARE(m_server.maxOpen(), 2);
+    }
+
+    void batchPausesForRetryAfter()
+    {
+        auto limited = std::make_shared<bool>(false);
+        m_server.setHandler([limited](const MockHttpServer::Request &request) {
+            const QString appId = appIdOf(request.target);
+            if (!*limited) {
+                *limited = true;
+                return MockHttpServer::Response{429, QByteArray(), {{"Retry-After", "1"}}, 0};
+            }
+            return MockHttpServer::Response{200, steamBody(appId, "Game " + appId, "CPU " + appId), {}, 0};
+        });
+
+        auto batch = startBatch(limits(4));
+        batch->fetcher->fetch({"2101"});
+        QTRY_COMPARE_WITH_TIMEOUT(m_server.requests().size(), 1, 2000);
+        QTest::qWait(100);
+        // Queued during the pause: must wait for Retry-After as well.
+        batch->fetcher->fetch({"2102"});
+
+        QTRY_COMPARE_WITH_TIMEOUT(batch->finishedCount, 1, 5000);
+        QCOMPARE(batch->results.size(), 2);
+        const QList<MockHttpServer::Request> requests = m_server.requests();
+        QCOMPARE(requests.size(), 3);
+        for (qsizetype i = 1; i < requests.size(); ++i) {
+            QVERIFY2(requests.at(i).receivedMs - requests.first().receivedMs >= 950,
+                     (requests.at(i).target + " after " + QByteArray::number(requests.at(i).receivedMs - requests.first().receivedMs) + " ms").constData());
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(RequirementsLookupTest)
+#include "tst_requirementslookup.moc"